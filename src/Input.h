@@ -1,5 +1,7 @@
 #pragma once
 
+#include "simulation/InputSnapshot.h"
+
 #include <GLFW/glfw3.h>
 
 void processKeyboardInputExit(GLFWwindow* window)
@@ -77,6 +79,22 @@ bool processPressingAlt(GLFWwindow* window)
     return false;
 }
 
+// Everything the frame needs from the mouse and keyboard in one go. cursorScaleFactor is the DPI correction (see main)
+simulation::InputSnapshot takeInputSnapshot(GLFWwindow* window, double cursorScaleFactor, bool mouseCaptured)
+{
+    double xCursorPos, yCursorPos;
+    glfwGetCursorPos(window, &xCursorPos, &yCursorPos);
+
+    simulation::InputSnapshot input{};
+    input.cursorPos = glm::vec2{ xCursorPos * cursorScaleFactor, yCursorPos * cursorScaleFactor };
+    // The button gets tracked even while ImGui has the mouse, so dragging off a window doesn't count as a click
+    input.clicked = processMouseInputClicking(window) && !mouseCaptured;
+    input.togglePlacingBoids = processPressingSpace(window);
+    input.toggleAvoidMouse = processPressingAlt(window);
+    input.toggleSettings = processPressingF1Key(window);
+    return input;
+}
+
 void resize_window(GLFWwindow* window, int width, int height)
 {
     (void)window; // This just gets rid of the unused parameter warning
@@ -0,0 +1,194 @@
+#include "Renderer.h"
+#include "Camera.h"
+#include "ShaderHandler.h"
+#include "simulation/boid/BoidParams.h"
+#include "simulation/obstacle/Obstacle.h"
+
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+namespace
+{
+    namespace globalVars = simulation::boid::globalVars;
+
+    // Where to draw boid i when the current time is interpolation (0 to 1) of the way from its previous step to its latest one
+    glm::vec2 getRenderPos(const simulation::RenderSnapshot& snapshot, size_t i, float interpolation)
+    {
+        const glm::vec2 pos{ snapshot.positions[i] };
+        const glm::vec2 prevPos{ snapshot.prevPositions[i] };
+
+        // A boid that just wrapped around the screen would get drawn sliding all the way across it
+        const glm::vec2 distance{ glm::abs(pos - prevPos) };
+        if (distance.x > snapshot.worldSize.x / 2.0f || distance.y > snapshot.worldSize.y / 2.0f)
+            return pos;
+
+        return glm::mix(prevPos, pos, interpolation);
+    }
+
+    // A VAO over a dynamic VBO holding vertices, for the circles and cones that get reshaped from the UI
+    void createFanVAO(GLuint& VAO, GLuint& VBO, const std::array<GLfloat, 104>& vertices)
+    {
+        glGenVertexArrays(1, &VAO);
+        glBindVertexArray(VAO);
+
+        glGenBuffers(1, &VBO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices.data(), GL_DYNAMIC_DRAW);
+
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(GLfloat), (void*)0);
+        glEnableVertexAttribArray(0);
+
+        glBindVertexArray(0);
+    }
+}
+
+namespace Renderer
+{
+    GLuint boidVAO{};
+    GLuint visionConeVAO{};
+    GLuint visionConeVBO{};
+    std::array<GLfloat, 104> visionConeVertices{ 0.0f };
+    GLuint obstacleVAO{};
+    GLuint obstacleVBO{};
+    std::array<GLfloat, 104> obstacleVertices{ 0.0f };
+
+    void init()
+    {
+        glPointSize(globalVars::triangleWidth / 1.5f); // The points will show up at m_pos when we render the cones so we can see exactly where the boids are visible
+
+        // Boid triangle VAO
+        // The coordinate frame is using screen resolution where the top left is 0,0. X points right and Y points down (because this is what GLFW uses)
+        const GLfloat vertices[]
+        {
+            -globalVars::triangleWidth, -globalVars::triangleHeight,
+            globalVars::triangleWidth, -globalVars::triangleHeight,
+            0.0f, globalVars::triangleHeight
+        };
+
+        glGenVertexArrays(1, &boidVAO);
+        glBindVertexArray(boidVAO);
+
+        GLuint VBO;
+        glGenBuffers(1, &VBO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(GLfloat), (void*)0);
+        glEnableVertexAttribArray(0);
+
+        glBindVertexArray(0);
+
+        // Boid vision cone/circle and obstacle VAOs. The vertices are already initialized to zero
+        createFanVAO(visionConeVAO, visionConeVBO, visionConeVertices);
+        createFanVAO(obstacleVAO, obstacleVBO, obstacleVertices);
+
+        recomputeVisionConeVBO(globalVars::visionRadius, globalVars::defaultVisionAngleDegrees);
+        recomputeObstacleVBO(simulation::obstacle::radius);
+    }
+
+    void recomputeVisionConeVBO(float visionRadius, float visionAngleDegrees)
+    {
+        // Recompute vision cone vertices
+        const size_t numSegments{ (visionConeVertices.size() - 4) / 2 };
+        const GLfloat stepSize{ glm::radians(visionAngleDegrees / static_cast<float>(numSegments)) };
+        const GLfloat startAngle{ glm::radians(((360.0f - visionAngleDegrees) / 2.0f) - 90.0f) };
+
+        size_t index{ 2 };
+        for (size_t i{ 0 }; i <= numSegments; ++i)
+        {
+            const GLfloat x{glm::cos(startAngle + (stepSize * static_cast<float>(i))) * visionRadius};
+            const GLfloat y{glm::sin(startAngle + (stepSize * static_cast<float>(i))) * visionRadius};
+            visionConeVertices[index++] = x;
+            visionConeVertices[index++] = y;
+        }
+
+        glBindBuffer(GL_ARRAY_BUFFER, visionConeVBO);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(visionConeVertices), visionConeVertices.data());
+    }
+
+    void recomputeObstacleVBO(float radius)
+    {
+        constexpr size_t numSegments{ (obstacleVertices.size() - 4) / 2 };
+        constexpr GLfloat stepSize{ glm::two_pi<float>() / static_cast<float>(numSegments) };
+
+        size_t index{ 2 };
+        for (size_t i{ 0 }; i <= numSegments; ++i)
+        {
+            const GLfloat x{glm::cos((stepSize * static_cast<float>(i))) * radius};
+            const GLfloat y{glm::sin((stepSize * static_cast<float>(i))) * radius};
+            obstacleVertices[index++] = x;
+            obstacleVertices[index++] = y;
+        }
+
+        glBindBuffer(GL_ARRAY_BUFFER, obstacleVBO);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(obstacleVertices), obstacleVertices.data());
+    }
+
+    void renderBoids(const simulation::RenderSnapshot& snapshot, float interpolation, bool showVisionCones)
+    {
+        // Remember that depth testing is off
+        // First, render the vision cones, then the outlines, then the boids themselves, and finally m_pos as points
+        if (showVisionCones)
+        {
+            glBindVertexArray(visionConeVAO);
+
+            glUniform3fv(glGetUniformLocation(ShaderHandler::shaderProgram, "color"), 1, glm::value_ptr(glm::vec3{ 0.1f, 0.1f, 0.1f }));
+            for (size_t i{ 0 }; i < snapshot.size(); ++i)
+            {
+                glm::mat4 model{ glm::translate(glm::mat4{ 1.0f }, glm::vec3{ getRenderPos(snapshot, i, interpolation), 0.0f }) };
+                model = glm::rotate(model, snapshot.rotations[i], glm::vec3{ 0.0f, 0.0f, 1.0f });
+                glUniformMatrix4fv(glGetUniformLocation(ShaderHandler::shaderProgram, "mvp"), 1, GL_FALSE, glm::value_ptr(Camera::viewProjection * model));
+                glDrawArrays(GL_TRIANGLE_FAN, 0, visionConeVertices.size());
+            }
+
+            glUniform3fv(glGetUniformLocation(ShaderHandler::shaderProgram, "color"), 1, glm::value_ptr(glm::vec3{ 0.35f, 0.35f, 0.35f }));
+            for (size_t i{ 0 }; i < snapshot.size(); ++i)
+            {
+                glm::mat4 model{ glm::translate(glm::mat4{ 1.0f }, glm::vec3{ getRenderPos(snapshot, i, interpolation), 0.0f }) };
+                model = glm::rotate(model, snapshot.rotations[i], glm::vec3{ 0.0f, 0.0f, 1.0f });
+                glUniformMatrix4fv(glGetUniformLocation(ShaderHandler::shaderProgram, "mvp"), 1, GL_FALSE, glm::value_ptr(Camera::viewProjection * model));
+                glDrawArrays(GL_LINE_LOOP, 0, visionConeVertices.size());
+            }
+        }
+
+        glBindVertexArray(boidVAO);
+        for (size_t i{ 0 }; i < snapshot.size(); ++i)
+        {
+            glUniform3fv(glGetUniformLocation(ShaderHandler::shaderProgram, "color"), 1, glm::value_ptr(snapshot.colors[i]));
+
+            glm::mat4 model{ glm::translate(glm::mat4{ 1.0f }, glm::vec3{ getRenderPos(snapshot, i, interpolation), 0.0f }) };
+            model = glm::rotate(model, snapshot.rotations[i], glm::vec3{ 0.0f, 0.0f, 1.0f });
+            glUniformMatrix4fv(glGetUniformLocation(ShaderHandler::shaderProgram, "mvp"), 1, GL_FALSE, glm::value_ptr(Camera::viewProjection * model));
+            glDrawArrays(GL_TRIANGLES, 0, 3);
+        }
+
+        // Render m_pos as a point so we can see exactly where the boids are visible in a render cone
+        if (showVisionCones)
+        {
+            glBindVertexArray(visionConeVAO);
+            glUniform3fv(glGetUniformLocation(ShaderHandler::shaderProgram, "color"), 1, glm::value_ptr(glm::vec3{ 1.0f, 0.0f, 0.0f }));
+            for (size_t i{ 0 }; i < snapshot.size(); ++i)
+            {
+                glPointSize(globalVars::triangleWidth / 1.5f);
+                glm::mat4 model{ glm::translate(glm::mat4{ 1.0f }, glm::vec3{ getRenderPos(snapshot, i, interpolation), 0.0f }) };
+                model = glm::rotate(model, snapshot.rotations[i], glm::vec3{ 0.0f, 0.0f, 1.0f });
+                glUniformMatrix4fv(glGetUniformLocation(ShaderHandler::shaderProgram, "mvp"), 1, GL_FALSE, glm::value_ptr(Camera::viewProjection * model));
+                glDrawArrays(GL_POINTS, 0, 1);
+            }
+        }
+    }
+
+    void renderObstacles(const std::vector<glm::vec2>& positions)
+    {
+        glBindVertexArray(obstacleVAO);
+        glUniform3fv(glGetUniformLocation(ShaderHandler::shaderProgram, "color"), 1, glm::value_ptr(glm::vec3{ 1.0f, 0.0f, 0.0f }));
+
+        for (const glm::vec2 pos : positions)
+        {
+            glm::mat4 model{ glm::translate(glm::mat4{ 1.0f }, glm::vec3{ pos, 0.0f }) };
+            glUniformMatrix4fv(glGetUniformLocation(ShaderHandler::shaderProgram, "mvp"), 1, GL_FALSE, glm::value_ptr(Camera::viewProjection * model));
+            glDrawArrays(GL_TRIANGLE_FAN, 0, obstacleVertices.size());
+        }
+    }
+}
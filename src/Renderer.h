@@ -0,0 +1,31 @@
+#pragma once
+
+#include "simulation/RenderSnapshot.h"
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <array>
+#include <vector>
+
+// Draws the simulation. It only ever sees it through a RenderSnapshot, which is what keeps GL out of boids_core. Everything
+// here needs a GL context
+namespace Renderer
+{
+    extern GLuint boidVAO;
+    extern GLuint visionConeVAO;
+    extern GLuint visionConeVBO;
+    extern std::array<GLfloat, 104> visionConeVertices; // So really 51 vertices (including middle)
+    extern GLuint obstacleVAO;
+    extern GLuint obstacleVBO;
+    extern std::array<GLfloat, 104> obstacleVertices; // Same as the vision cone
+
+    // The shapes get their sizes from the simulation's, so globalVars::init and obstacle::init have to have run
+    void init();
+    void recomputeVisionConeVBO(float visionRadius, float visionAngleDegrees);
+    void recomputeObstacleVBO(float radius);
+
+    // interpolation is how far (0 to 1) to draw the boids between their previous and latest step
+    void renderBoids(const simulation::RenderSnapshot& snapshot, float interpolation, bool showVisionCones);
+    void renderObstacles(const std::vector<glm::vec2>& positions);
+}
@@ -0,0 +1,516 @@
+#pragma once
+
+#include "Camera.h"
+#include "Renderer.h"
+#include "simulation/boid/BoidParams.h"
+#include "simulation/boid/BoidObject.h"
+#include "simulation/boid/SpatialGrid.h"
+#include "simulation/boid/MortonOrder.h"
+#include "simulation/boid/FlockKernel.h"
+#include "simulation/boid/SymmetricPass.h"
+#include "simulation/boid/FarField.h"
+#include "simulation/boid/GhostLayer.h"
+#include "simulation/boid/FlockStats.h"
+#include "simulation/boid/Determinism.h"
+#include "simulation/FixedTimestep.h"
+#include "simulation/SimParams.h"
+#include "simulation/SimulationThread.h"
+#include "simulation/RenderSnapshot.h"
+#include "simulation/FastMath.h"
+#include "simulation/FrameArena.h"
+#include "simulation/AlignedAllocator.h"
+#include "simulation/obstacle/Obstacle.h"
+
+#include "imgui.h"
+#include "imgui_impl_glfw.h"
+#include "imgui_impl_opengl3.h"
+
+#include <array>
+#include <iostream>
+#include <optional>
+#include <algorithm>
+#include <thread>
+
+#include "lodepng.h"
+
+#include "stb_image_resize.h"
+
+namespace simulation::ui
+{
+    inline bool placingBoids{ true };
+    // *****
+    // Boids
+    // *****
+    inline float separationScale{ 1.0f };
+    inline float alignmentScale{ 1.0f };
+    inline float cohesionScale{ 1.0f };
+
+    inline float visionRadiusScale{ 1.0f };
+    inline float visionAngleDegrees{ boid::globalVars::defaultVisionAngleDegrees };
+    inline float maxSpeedScale{ 1.0f };
+
+    inline bool showVisionCones{ false };
+
+    inline int numBoidsPerClick{ 1 };
+    inline bool randomizeGroupBoidPositions{ false };
+    inline bool groupBoidsPointInSameDir{ true };
+    inline bool groupBoidsShareSameHue{ false };
+
+    inline bool blendHues{ true };
+
+    // Only flock with the k nearest visible boids (starlings go by about 7) instead of every boid in the vision radius
+    inline bool topologicalNeighbors{ false };
+    inline int topologicalNeighborCount{ 7 };
+
+    // Barnes-Hut style approximation for big vision radii. Bigger opening angles approximate more (and more coarsely)
+    inline bool farFieldAggregates{ false };
+    inline float farFieldOpeningAngle{ 0.5f };
+
+    // *********
+    // Obstacles
+    // *********
+    inline float obstacleRadiusScale{ 1.0f };
+
+    inline bool avoidMouse{ false };
+    inline float avoidMouseScale{ 1.0f };
+
+    // ***********
+    // Performance
+    // ***********
+    // The simulation runs in fixed steps of 1 / simulationTickRate seconds, at most maxStepsPerFrame of them per frame
+    inline int simulationTickRate{ 120 };
+    inline int maxStepsPerFrame{ 4 };
+    inline int numThreads{ static_cast<int>(std::max(std::thread::hardware_concurrency(), 1u)) };
+    inline bool useSimdKernel{ true };
+    inline bool fastMath{ false };
+    inline bool cullNeighborCells{ true };
+    inline bool ghostCells{ true };
+    inline bool symmetricPairs{ false };
+    inline bool mortonReorder{ false };
+    // Positions, velocities and hues packed into 16 bits each (see BoidStore::Storage)
+    inline bool compactBoidState{ false };
+    // Reproducible steps from a fixed seed (see boid/Determinism.h)
+    inline bool deterministic{ false };
+    inline int deterministicSeed{ 1 };
+    // Each boid only redoes its neighbor search every this many steps and reuses its flocking steering in between
+    inline int flockUpdateInterval{ 1 };
+    inline int mortonReorderInterval{ 60 };
+    // Measured in main, since drawing happens on the render thread
+    inline float drawSubmissionMilliseconds{ 0.0f };
+
+    namespace cursors
+    {
+		inline double cursorScaleFactor{ 1.0 };
+        inline GLFWcursor* whiteCursor{};
+        inline GLFWcursor* redCursor{};
+
+        inline void initCursors(float i_cursorScaleFactor) {
+			cursorScaleFactor = i_cursorScaleFactor;
+
+            ImGui::GetIO().ConfigFlags |= ImGuiConfigFlags_NoMouseCursorChange;
+
+            const int cursorSize{ static_cast<int>( (Camera::screenWidth * (5.0f / 384.0f)) / cursorScaleFactor ) };
+
+            // White cursor
+            {
+                std::vector<unsigned char> whiteCursorImage;
+                unsigned int imageWidth, imageHeight;
+                lodepng::decode(whiteCursorImage, imageWidth, imageHeight, "../assets/white_cursor.png");
+                std::vector<unsigned char> whiteCursorResized(cursorSize * cursorSize * 4);
+                stbir_resize_uint8(
+                        whiteCursorImage.data(), imageWidth, imageWidth, 0,
+                        whiteCursorResized.data(), cursorSize, cursorSize, 0, 4
+                );
+
+                GLFWimage whiteCursorGlfwImage;
+                whiteCursorGlfwImage.width = cursorSize;
+                whiteCursorGlfwImage.height = cursorSize;
+                whiteCursorGlfwImage.pixels = whiteCursorResized.data();
+
+                whiteCursor = glfwCreateCursor(&whiteCursorGlfwImage, 7, 0); // hotspot in center
+            }
+
+            // Red cursor
+            {
+                std::vector<unsigned char> redCursorImage;
+                unsigned int imageWidth, imageHeight;
+                lodepng::decode(redCursorImage, imageWidth, imageHeight, "../assets/red_cursor.png");
+                std::vector<unsigned char> redCursorResized(cursorSize * cursorSize * 4);
+                stbir_resize_uint8(
+                        redCursorImage.data(), imageWidth, imageWidth, 0,
+                        redCursorResized.data(), cursorSize, cursorSize, 0, 4
+                );
+
+                GLFWimage redCursorGlfwImage;
+                redCursorGlfwImage.width = cursorSize;
+                redCursorGlfwImage.height = cursorSize;
+                redCursorGlfwImage.pixels = redCursorResized.data();
+
+                redCursor = glfwCreateCursor(&redCursorGlfwImage, 7, 0); // hotspot in center
+            }
+
+            // Set current cursor
+            glfwSetCursor(Camera::window, whiteCursor);
+        }
+    }
+
+    // Everything the simulation thread needs from the settings above
+    inline SimParams getSimParams()
+    {
+        SimParams params{};
+        params.worldSize = { Camera::screenWidth, Camera::screenHeight };
+        params.wrapMargin = boid::globalVars::triangleHeight;
+        params.separation = boid::globalVars::separation;
+        params.alignment = boid::globalVars::alignment;
+        params.cohesion = boid::globalVars::cohesion;
+        params.maxSpeed = boid::globalVars::maxSpeed;
+        params.visionRadius = boid::globalVars::visionRadius;
+        params.visionAngleCos = boid::globalVars::visionAngleCos;
+        params.blendHues = blendHues;
+        params.topologicalNeighbors = topologicalNeighbors;
+        params.topologicalNeighborCount = topologicalNeighborCount;
+        params.farFieldAggregates = farFieldAggregates;
+        params.farFieldOpeningAngle = farFieldOpeningAngle;
+
+        params.saturation = boid::globalVars::saturation;
+        params.brightness = boid::globalVars::brightness;
+
+        params.obstacleRadius = obstacle::radius;
+        params.avoidMouse = avoidMouse;
+        params.avoidMouseScale = avoidMouseScale;
+
+        params.numBoidsPerClick = numBoidsPerClick;
+        params.randomizeGroupBoidPositions = randomizeGroupBoidPositions;
+        params.groupBoidsPointInSameDir = groupBoidsPointInSameDir;
+        params.groupBoidsShareSameHue = groupBoidsShareSameHue;
+
+        params.simulationTickRate = simulationTickRate;
+        params.maxStepsPerFrame = maxStepsPerFrame;
+        params.numThreads = numThreads;
+        params.useSimdKernel = useSimdKernel;
+        params.precision = fastMath ? fastmath::Precision::fast : fastmath::Precision::exact;
+        params.cullNeighborCells = cullNeighborCells;
+        params.ghostCells = ghostCells;
+        params.symmetricPairs = symmetricPairs;
+        params.mortonReorder = mortonReorder;
+        params.mortonReorderInterval = mortonReorderInterval;
+        params.flockUpdateInterval = flockUpdateInterval;
+        params.compactBoidState = compactBoidState;
+        params.deterministic = deterministic;
+        params.deterministicSeed = static_cast<uint64_t>(deterministicSeed);
+        return params;
+    }
+
+    // Everything about the simulation itself comes from snapshot, since the simulation thread could be mid step. Buttons
+    // that change the simulation post to it instead of doing it here
+    inline void renderUI(const RenderSnapshot& snapshot)
+    {
+        const SimulationStats& stats{ snapshot.stats };
+        ImGui::Begin("Settings", nullptr, ImGuiWindowFlags_AlwaysAutoResize);
+        ImGui::PushItemWidth(Camera::screenWidth / 20.0f);
+        bool changed{ false };
+
+        if (ImGui::CollapsingHeader("Primary")) 
+        {
+            // Separation scale
+            changed = ImGui::SliderFloat("Separation scale", &separationScale, 0.0f, 8.0f);
+            ImGui::SameLine();
+            changed |= ImGui::InputFloat("##SeparationInput", &separationScale, 1.0f);
+            if (changed)
+            {
+                separationScale = std::clamp(separationScale, 0.0f, 8.0f);
+                boid::globalVars::separation = boid::globalVars::defaultSeparation * separationScale;
+            }
+
+            // Alignment scale
+            changed = ImGui::SliderFloat("Alignment scale", &alignmentScale, 0.0f, 8.0f);
+            ImGui::SameLine();
+            changed |= ImGui::InputFloat("##AlignmentInput", &alignmentScale, 1.0f);
+            if (changed)
+            {
+                alignmentScale = std::clamp(alignmentScale, 0.0f, 8.0f);
+                boid::globalVars::alignment = boid::globalVars::defaultAlignment * alignmentScale;
+            }
+
+            // Cohesion scale
+            changed = ImGui::SliderFloat("Cohesion scale", &cohesionScale, 0.0f, 8.0f);
+            ImGui::SameLine();
+            changed |= ImGui::InputFloat("##CohesionInput", &cohesionScale, 1.0f);
+            if (changed)
+            {
+                cohesionScale = std::clamp(cohesionScale, 0.0f, 8.0f);
+                boid::globalVars::cohesion = boid::globalVars::defaultCohesion * cohesionScale;
+            }
+
+            // Max speed scale
+            changed |= ImGui::SliderFloat("Max speed scale", &maxSpeedScale, 0.0f, 4.0f);
+            ImGui::SameLine();
+            changed |= ImGui::InputFloat("##MaxSpeedInput", &maxSpeedScale, 0.5f);
+            if (changed)
+            {
+                maxSpeedScale = std::clamp(maxSpeedScale, 0.0f, 4.0f);
+                boid::globalVars::maxSpeed = boid::globalVars::defaultMaxSpeed * maxSpeedScale;
+            }
+        }
+
+        if (ImGui::CollapsingHeader("Radius")) 
+        {
+            ImGui::Checkbox("Show vision cones", &showVisionCones);
+
+            changed = ImGui::SliderFloat("Radius scale", &visionRadiusScale, 0.0f, 8.0f);
+            ImGui::SameLine();
+            changed |= ImGui::InputFloat("##RadiusInput", &visionRadiusScale, 1.0f);
+            if (changed)
+            {
+                visionRadiusScale = std::clamp(visionRadiusScale, 0.0f, 8.0f);
+                boid::globalVars::visionRadius = boid::globalVars::defaultVisionRadius * visionRadiusScale;
+                Renderer::recomputeVisionConeVBO(boid::globalVars::visionRadius, visionAngleDegrees);
+            }
+
+            changed = ImGui::SliderFloat("Vision angle (degrees)", &visionAngleDegrees, 0.0f, 360.0f);
+            ImGui::SameLine();
+            changed |= ImGui::InputFloat("##VisionAngleInput", &visionAngleDegrees, 5.0f);
+            if (changed)
+            {
+                visionAngleDegrees = std::clamp(visionAngleDegrees, 0.0f, 360.0f);
+                boid::globalVars::visionAngleCos = glm::cos(glm::radians(visionAngleDegrees) / 2.0f);
+                Renderer::recomputeVisionConeVBO(boid::globalVars::visionRadius, visionAngleDegrees);
+            }
+
+            ImGui::Checkbox("Topological neighbors (k nearest)", &topologicalNeighbors);
+
+            if (!topologicalNeighbors)
+                ImGui::BeginDisabled();
+
+            ImGui::SliderInt("Neighbors (k)", &topologicalNeighborCount, 1, boid::kernel::maxTopologicalNeighbors);
+            ImGui::SameLine();
+            ImGui::InputInt("##NeighborCountInput", &topologicalNeighborCount, 1);
+            topologicalNeighborCount = std::clamp(topologicalNeighborCount, 1, boid::kernel::maxTopologicalNeighbors);
+
+            if (!topologicalNeighbors)
+                ImGui::EndDisabled();
+
+            ImGui::Checkbox("Far-field aggregates", &farFieldAggregates);
+            if (farFieldAggregates && topologicalNeighbors)
+            {
+                ImGui::SameLine();
+                ImGui::TextDisabled("(not used with topological neighbors)");
+            }
+
+            if (!farFieldAggregates)
+                ImGui::BeginDisabled();
+
+            ImGui::SliderFloat("Opening angle", &farFieldOpeningAngle, 0.0f, 1.5f);
+            ImGui::SameLine();
+            ImGui::InputFloat("##OpeningAngleInput", &farFieldOpeningAngle, 0.1f);
+            farFieldOpeningAngle = std::clamp(farFieldOpeningAngle, 0.0f, 1.5f);
+
+            if (ImGui::Button("Measure error"))
+                simthread::post({ simthread::Command::Type::measureFarFieldError });
+
+            const boid::farfield::ErrorStats& error{ stats.farFieldError };
+            if (error.numSampled > 0)
+            {
+                ImGui::Text("Error over %d boids (mean / max):", static_cast<int>(error.numSampled));
+                ImGui::Text("  Separation %.2f%% / %.2f%%", error.meanSeparation * 100.0f, error.maxSeparation * 100.0f);
+                ImGui::Text("  Alignment %.2f%% / %.2f%%", error.meanAlignment * 100.0f, error.maxAlignment * 100.0f);
+                ImGui::Text("  Cohesion %.2f%% / %.2f%%", error.meanCohesion * 100.0f, error.maxCohesion * 100.0f);
+            }
+
+            if (!farFieldAggregates)
+                ImGui::EndDisabled();
+        }
+
+        // I'm not doing the changed bool thing here since there's not many computations going on
+        if (ImGui::CollapsingHeader("Boids")) 
+        {
+            ImGui::SliderInt("Boids per click", &numBoidsPerClick, 1, 100);
+            ImGui::SameLine();
+            ImGui::InputInt("##NumBoidsInput", &numBoidsPerClick, 1);
+            numBoidsPerClick = std::clamp(numBoidsPerClick, 1, 100);
+
+            ImGui::Checkbox("Randomize group boid positions", &randomizeGroupBoidPositions);
+
+            if (!randomizeGroupBoidPositions)
+                ImGui::BeginDisabled();
+
+            ImGui::Checkbox("Group points share heading", &groupBoidsPointInSameDir);
+
+            if (!randomizeGroupBoidPositions)
+                ImGui::EndDisabled();
+
+            ImGui::Checkbox("Boids in group share same hue", &groupBoidsShareSameHue);
+
+            if (ImGui::Button("Clear boids"))
+                simthread::post({ simthread::Command::Type::clearBoids });
+        }
+
+        if (ImGui::CollapsingHeader("Obstacles"))
+        {
+            ImGui::Checkbox("Placing boids", &placingBoids);
+
+            ImGui::Checkbox("Avoid mouse", &avoidMouse);
+            changed = ImGui::SliderFloat("Avoid mouse scale", &avoidMouseScale, 0.1f, 20.0f);
+            ImGui::SameLine();
+            changed |= ImGui::InputFloat("##AvoidMouseScaleInput", &avoidMouseScale, 1.0f);
+            if (changed)
+                avoidMouseScale = std::clamp(avoidMouseScale, 0.1f, 20.0f);
+
+            changed = ImGui::SliderFloat("Radius scale", &obstacleRadiusScale, 0.1f, 8.0f);
+            ImGui::SameLine();
+            changed |= ImGui::InputFloat("##RadiusInput", &obstacleRadiusScale, 1.0f);
+            if (changed)
+            {
+                obstacleRadiusScale = std::clamp(obstacleRadiusScale, 0.1f, 8.0f);
+                obstacle::radius = obstacle::defaultRadius * obstacleRadiusScale;
+                Renderer::recomputeObstacleVBO(obstacle::radius);
+            }
+
+            if (ImGui::Button("Create obstacle circle"))
+                simthread::post({ simthread::Command::Type::makeBigCircleObstacle });
+
+            if (ImGui::Button("Clear obstacles"))
+                simthread::post({ simthread::Command::Type::clearObstacles });
+        }
+
+        if (ImGui::CollapsingHeader("Color")) 
+        {
+            ImGui::SliderFloat("Saturation", &boid::globalVars::saturation, 0.003f, 1.0f); // Not letting it go to zero to avoid a zero division error in updateBoids
+            ImGui::SameLine();
+            ImGui::InputFloat("##SaturationInput", &boid::globalVars::saturation, 1.0f);
+            boid::globalVars::saturation = std::clamp(boid::globalVars::saturation, 0.003f, 1.0f);
+
+            ImGui::SliderFloat("Brightness", &boid::globalVars::brightness, 0.0f, 1.0f);
+            ImGui::SameLine();
+            ImGui::InputFloat("##BrightnessInput", &boid::globalVars::brightness, 1.0f);
+            boid::globalVars::brightness = std::clamp(boid::globalVars::brightness, 0.0f, 1.0f);
+
+            ImGui::Checkbox("Blend hues", &blendHues);
+
+            if (ImGui::Button("Randomize Hues"))
+                simthread::post({ simthread::Command::Type::randomizeHues });
+        }
+
+        if (ImGui::CollapsingHeader("Performance"))
+        {
+            ImGui::Text("Frame time: %.2f ms (%d boids)", 1000.0f / ImGui::GetIO().Framerate, static_cast<int>(snapshot.size()));
+
+            ImGui::SliderInt("Simulation rate (Hz)", &simulationTickRate, 10, 480);
+            ImGui::SameLine();
+            ImGui::InputInt("##SimulationRateInput", &simulationTickRate, 10);
+            simulationTickRate = std::clamp(simulationTickRate, 10, 480);
+
+            ImGui::SliderInt("Max steps per frame", &maxStepsPerFrame, 1, 16);
+            ImGui::SameLine();
+            ImGui::InputInt("##MaxStepsInput", &maxStepsPerFrame, 1);
+            maxStepsPerFrame = std::clamp(maxStepsPerFrame, 1, 16);
+            ImGui::Text("%d steps last frame, %.2f s dropped so far, last step took %.3f ms", stats.stepsLastFrame, stats.droppedTime,
+                        stats.lastStepMilliseconds);
+            for (const TaskGraph::Timing& timing : stats.stepTimings)
+            {
+                if (timing.ran)
+                    ImGui::Text("  %s: %.3f ms (%.3f average)", timing.name, timing.milliseconds, timing.averageMilliseconds);
+                else
+                    ImGui::TextDisabled("  %s: skipped", timing.name);
+            }
+            ImGui::Text("  Instance fill: %.3f ms, draw submission: %.3f ms", stats.instanceFillMilliseconds, drawSubmissionMilliseconds);
+
+            constexpr float bytesPerMB{ 1024.0f * 1024.0f };
+            ImGui::Text("Frame arena: %.2f MB (peak step %.2f MB), %d heap allocations last step", stats.arenaCapacity / bytesPerMB,
+                        stats.arenaHighWaterMark / bytesPerMB, stats.arenaHeapAllocations);
+            ImGui::Text("Huge page mappings: %.2f MB (%s)", hugepages::mappedBytes.load() / bytesPerMB, hugepages::lastWasExplicit ? "reserved pages" : "transparent");
+
+            ImGui::Checkbox("Compact boid state (16 bit)", &compactBoidState);
+            ImGui::SameLine();
+            ImGui::TextDisabled("(%d bytes per boid)", static_cast<int>(stats.bytesPerBoid));
+            if (ImGui::Button("Measure flock##FlockStats"))
+                simthread::post({ simthread::Command::Type::measureFlock });
+            if (stats.flockStats)
+            {
+                ImGui::SameLine();
+                ImGui::Text("Polarization %.3f, %.2f neighbors on average", stats.flockStats->polarization, stats.flockStats->averageNeighbors);
+            }
+
+            const int maxThreads{ static_cast<int>(std::max(std::thread::hardware_concurrency(), 1u)) };
+            ImGui::SliderInt("Threads", &numThreads, 1, maxThreads);
+            ImGui::SameLine();
+            ImGui::InputInt("##ThreadsInput", &numThreads, 1);
+            numThreads = std::clamp(numThreads, 1, maxThreads);
+
+            ImGui::Checkbox("SIMD neighbor kernel", &useSimdKernel);
+            ImGui::SameLine();
+            ImGui::TextDisabled("(%s)", boid::kernel::getSimdKernelName());
+
+            ImGui::Checkbox("Fast approximate math", &fastMath);
+            ImGui::SameLine();
+            static std::optional<fastmath::ErrorStats> fastMathErrors{};
+            if (ImGui::Button("Measure error##FastMath"))
+                fastMathErrors = fastmath::measureErrors();
+            if (fastMathErrors)
+            {
+                ImGui::Text("Max error: rsqrt %.1e (relative), sincos %.1e, atan2 %.1e, wrap %.1e", fastMathErrors->rsqrtRelative,
+                            fastMathErrors->sinCosAbsolute, fastMathErrors->atan2Absolute, fastMathErrors->wrapAbsolute);
+            }
+
+            ImGui::Checkbox("Deterministic mode", &deterministic);
+            ImGui::SameLine();
+            ImGui::InputInt("Seed##Deterministic", &deterministicSeed, 1);
+            if (deterministic)
+            {
+                ImGui::Text("State hash after step %llu: %016llx", static_cast<unsigned long long>(stats.hashedStep),
+                            static_cast<unsigned long long>(stats.stateHash));
+                ImGui::TextDisabled("(scalar fixed-point sums, far field, symmetric pass and ghost cells are skipped)");
+            }
+
+            ImGui::Checkbox("Vision cone cell culling", &cullNeighborCells);
+
+            ImGui::Checkbox("Ghost cells for wraparound", &ghostCells);
+            if (ghostCells && !stats.ghostCellsAvailable)
+            {
+                ImGui::SameLine();
+                ImGui::TextDisabled("(needs at least a 3x3 grid, wrapping per pair)");
+            }
+            ImGui::Text("%d ghost boids, rebuilt in %.3f ms, %.2f MB", static_cast<int>(stats.numGhosts), stats.ghostRebuildMilliseconds,
+                        stats.ghostMemoryUsage / bytesPerMB);
+
+            ImGui::Checkbox("Symmetric pair pass (slower than the grid without AVX2, see SymmetricPass.h)", &symmetricPairs);
+            if (symmetricPairs && !stats.symmetricPassAvailable)
+            {
+                ImGui::SameLine();
+                ImGui::TextDisabled("(needs at least a 3x3 grid, using per-boid kernel)");
+            }
+            else if (symmetricPairs && (topologicalNeighbors || farFieldAggregates || flockUpdateInterval > 1))
+            {
+                ImGui::SameLine();
+                ImGui::TextDisabled("(not used with topological neighbors, far-field aggregates or staggered updates)");
+            }
+
+            ImGui::SliderInt("Flocking update interval (steps)", &flockUpdateInterval, 1, 16);
+            ImGui::SameLine();
+            ImGui::InputInt("##FlockUpdateIntervalInput", &flockUpdateInterval, 1);
+            flockUpdateInterval = std::clamp(flockUpdateInterval, 1, 16);
+            if (flockUpdateInterval > 1)
+            {
+                ImGui::SameLine();
+                ImGui::TextDisabled("(1/%d of the flock per step)", flockUpdateInterval);
+            }
+
+            ImGui::Checkbox("Morton reordering", &mortonReorder);
+
+            if (!mortonReorder)
+                ImGui::BeginDisabled();
+
+            ImGui::SliderInt("Reorder interval (frames)", &mortonReorderInterval, 1, 600);
+            ImGui::SameLine();
+            ImGui::InputInt("##ReorderIntervalInput", &mortonReorderInterval, 10);
+            mortonReorderInterval = std::clamp(mortonReorderInterval, 1, 600);
+            ImGui::Text("Locality: %.2f (%.2f after last reorder)", stats.mortonLocality, stats.mortonLocalityAfterLastReorder);
+
+            if (!mortonReorder)
+                ImGui::EndDisabled();
+        }
+
+        ImGui::PopItemWidth();
+        ImGui::End();
+    }
+}
@@ -0,0 +1,321 @@
+#include "../simulation/boid/BoidObject.h"
+#include "../simulation/boid/BoidParams.h"
+#include "../simulation/boid/FlockKernel.h"
+#include "../simulation/boid/Determinism.h"
+#include "../simulation/obstacle/Obstacle.h"
+#include "../simulation/CpuFeatures.h"
+#include "../simulation/InputSnapshot.h"
+#include "../simulation/SimParams.h"
+#include "../simulation/Random.h"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+
+// Runs the simulation with no window or GL context, for benchmarking and long runs on machines without a GPU. The world
+// is worldWidth x worldHeight instead of the screen, and everything that scales with the screen scales with that
+namespace
+{
+    namespace boid = simulation::boid;
+
+    struct Options
+    {
+        float worldWidth{ 1920.0f };
+        float worldHeight{ 1080.0f };
+        size_t numBoids{ 10000 };
+        int numSteps{ 1000 };
+        int tickRate{ 120 };
+        std::optional<uint64_t> seed{};
+        std::optional<std::string_view> simdLevel{};
+        // The boids' final state gets written here as CSV if it's set
+        std::optional<std::string> outputPath{};
+        bool bigCircleObstacle{ false };
+        bool showHelp{ false };
+
+        // Same meaning as the UI's sliders: multiples of the defaults, which scale with the world size
+        float separationScale{ 1.0f };
+        float alignmentScale{ 1.0f };
+        float cohesionScale{ 1.0f };
+        float maxSpeedScale{ 1.0f };
+        float visionRadiusScale{ 1.0f };
+        float visionAngleDegrees{ 270.0f };
+
+        // Everything else goes straight through
+        simulation::SimParams params{};
+    };
+
+    void printUsage()
+    {
+        std::cout <<
+            "Usage: boids_headless [options]\n"
+            "  --width <float>, --height <float>   World size (default 1920 x 1080)\n"
+            "  --boids <count>                     Number of boids, scattered over the world (default 10000)\n"
+            "  --steps <count>                     Steps to run (default 1000)\n"
+            "  --tick-rate <steps per second>      Simulated time per step is 1 / this (default 120)\n"
+            "  --seed <int>                        Random seed (default: picked at startup, or 1 with --deterministic)\n"
+            "  --output <path>                     Write the final id,x,y,vx,vy,hue of every boid as CSV\n"
+            "  --threads <count>                   Simulation threads (default: all hardware threads)\n"
+            "  --simd <scalar|sse4.2|avx2|avx512>  Neighbor kernel (default: BOIDS_SIMD, or the best the CPU supports)\n"
+            "  --separation, --alignment, --cohesion, --max-speed, --vision-radius <scale>\n"
+            "                                      Multiples of the defaults, like the UI's sliders\n"
+            "  --vision-angle <degrees>            (default 270)\n"
+            "  --topological <k>                   Flock with the k nearest visible boids\n"
+            "  --far-field <opening angle>         Approximate distant boids with cell aggregates\n"
+            "  --flock-update-interval <steps>     Stagger the neighbor searches over this many steps\n"
+            "  --obstacles                         Add the big circle of obstacles\n"
+            "  --avoid-mouse                       Avoid a cursor parked in the middle of the world\n"
+            "  --no-blend-hues                     Don't blend the hues (which also turns the hue noise off)\n"
+            "  --saturation <0-1>                  Color saturation, the hues get noise below 0.7 (default 0.35)\n"
+            "  --deterministic                     Reproducible steps, printing the state hash at the end\n"
+            "  --fast-math, --compact, --symmetric, --morton, --no-ghost-cells\n"
+            "                                      The performance options from the UI\n";
+    }
+
+    template<typename T>
+    bool parseNumber(std::string_view text, T& value)
+    {
+        const auto [end, error]{ std::from_chars(text.data(), text.data() + text.size(), value) };
+        return error == std::errc{} && end == text.data() + text.size();
+    }
+
+    // Returns nullopt (after saying why) if the arguments don't make sense
+    std::optional<Options> parseOptions(int argc, char** argv)
+    {
+        Options options{};
+        options.params.numThreads = static_cast<int>(std::max(std::thread::hardware_concurrency(), 1u));
+
+        for (int i{ 1 }; i < argc; ++i)
+        {
+            std::string_view name{ argv[i] };
+            std::optional<std::string_view> inlineValue{};
+            if (const size_t equals{ name.find('=') }; equals != std::string_view::npos)
+            {
+                inlineValue = name.substr(equals + 1);
+                name = name.substr(0, equals);
+            }
+
+            // The flags, which don't take a value
+            bool* flag{ nullptr };
+            bool isFlag{ true };
+            if (name == "--obstacles")
+                flag = &options.bigCircleObstacle;
+            else if (name == "--avoid-mouse")
+                flag = &options.params.avoidMouse;
+            else if (name == "--no-blend-hues")
+                options.params.blendHues = false;
+            else if (name == "--deterministic")
+                flag = &options.params.deterministic;
+            else if (name == "--compact")
+                flag = &options.params.compactBoidState;
+            else if (name == "--symmetric")
+                flag = &options.params.symmetricPairs;
+            else if (name == "--morton")
+                flag = &options.params.mortonReorder;
+            else if (name == "--fast-math")
+                options.params.precision = simulation::fastmath::Precision::fast;
+            else if (name == "--no-ghost-cells")
+                options.params.ghostCells = false;
+            else if (name == "--help" || name == "-h")
+                flag = &options.showHelp;
+            else
+                isFlag = false;
+
+            if (isFlag)
+            {
+                if (inlineValue)
+                {
+                    std::cout << name << " doesn't take a value\n";
+                    return std::nullopt;
+                }
+                if (flag)
+                    *flag = true;
+                continue;
+            }
+
+            // Everything else takes a value
+            if (!inlineValue && i + 1 >= argc)
+            {
+                std::cout << "Missing a value for " << name << "\n";
+                return std::nullopt;
+            }
+            const std::string_view value{ inlineValue ? *inlineValue : std::string_view{ argv[++i] } };
+
+            bool valid{ true };
+            if (name == "--width")
+                valid = parseNumber(value, options.worldWidth) && options.worldWidth > 0.0f;
+            else if (name == "--height")
+                valid = parseNumber(value, options.worldHeight) && options.worldHeight > 0.0f;
+            else if (name == "--boids")
+                valid = parseNumber(value, options.numBoids);
+            else if (name == "--steps")
+                valid = parseNumber(value, options.numSteps) && options.numSteps >= 0;
+            else if (name == "--tick-rate")
+                valid = parseNumber(value, options.tickRate) && options.tickRate > 0;
+            else if (name == "--seed")
+                valid = parseNumber(value, options.seed.emplace());
+            else if (name == "--output")
+                options.outputPath = std::string{ value };
+            else if (name == "--threads")
+                valid = parseNumber(value, options.params.numThreads) && options.params.numThreads > 0;
+            else if (name == "--simd")
+                options.simdLevel = value;
+            else if (name == "--separation")
+                valid = parseNumber(value, options.separationScale);
+            else if (name == "--alignment")
+                valid = parseNumber(value, options.alignmentScale);
+            else if (name == "--cohesion")
+                valid = parseNumber(value, options.cohesionScale);
+            else if (name == "--max-speed")
+                valid = parseNumber(value, options.maxSpeedScale);
+            else if (name == "--vision-radius")
+                valid = parseNumber(value, options.visionRadiusScale) && options.visionRadiusScale > 0.0f;
+            else if (name == "--vision-angle")
+                valid = parseNumber(value, options.visionAngleDegrees);
+            else if (name == "--topological")
+            {
+                options.params.topologicalNeighbors = true;
+                valid = parseNumber(value, options.params.topologicalNeighborCount) && options.params.topologicalNeighborCount > 0;
+            }
+            else if (name == "--far-field")
+            {
+                options.params.farFieldAggregates = true;
+                valid = parseNumber(value, options.params.farFieldOpeningAngle);
+            }
+            else if (name == "--saturation")
+                valid = parseNumber(value, options.params.saturation) && options.params.saturation >= 0.0f && options.params.saturation <= 1.0f;
+            else if (name == "--flock-update-interval")
+                valid = parseNumber(value, options.params.flockUpdateInterval) && options.params.flockUpdateInterval > 0;
+            else
+            {
+                std::cout << "Unknown option " << name << " (see --help)\n";
+                return std::nullopt;
+            }
+
+            if (!valid)
+            {
+                std::cout << "Bad value \"" << value << "\" for " << name << "\n";
+                return std::nullopt;
+            }
+        }
+
+        return options;
+    }
+
+    // What the UI would hand the simulation thread with these settings. globalVars::init and obstacle::init have to have
+    // run, since the defaults come from there
+    void fillParams(Options& options)
+    {
+        simulation::SimParams& params{ options.params };
+        params.worldSize = { options.worldWidth, options.worldHeight };
+        params.wrapMargin = boid::globalVars::triangleHeight;
+        params.separation = boid::globalVars::defaultSeparation * options.separationScale;
+        params.alignment = boid::globalVars::defaultAlignment * options.alignmentScale;
+        params.cohesion = boid::globalVars::defaultCohesion * options.cohesionScale;
+        params.maxSpeed = boid::globalVars::defaultMaxSpeed * options.maxSpeedScale;
+        params.visionRadius = boid::globalVars::defaultVisionRadius * options.visionRadiusScale;
+        params.visionAngleCos = std::cos(glm::radians(options.visionAngleDegrees) / 2.0f);
+        params.obstacleRadius = simulation::obstacle::radius;
+        params.simulationTickRate = options.tickRate;
+
+        // What deterministic mode draws with (see getSeed in SimParams.h)
+        if (options.seed)
+            params.deterministicSeed = *options.seed;
+    }
+
+    // Spreads the boids evenly over the world. Where each one goes comes from its own spawn draws, so a given seed always
+    // gives the same flock
+    void spawnBoids(const simulation::SimParams& params, size_t numBoids)
+    {
+        boid::BoidObject::s_boids.reserve(numBoids);
+        for (size_t i{ 0 }; i < numBoids; ++i)
+        {
+            const std::array<float, 4> placement{ simulation::random::drawCentered(simulation::getSeed(params), simulation::random::Stream::spawn, boid::BoidObject::s_boids.getNextId(), 1) };
+            boid::BoidObject::createBoid(params, glm::vec2{ placement[0] + 1.0f, placement[1] + 1.0f } / 2.0f * params.worldSize);
+        }
+    }
+
+    bool writeBoids(const std::string& path)
+    {
+        std::ofstream file{ path };
+        if (!file)
+            return false;
+
+        const boid::BoidStore& boids{ boid::BoidObject::s_boids };
+        file << "id,x,y,vx,vy,hue\n";
+        for (size_t i{ 0 }; i < boids.size(); ++i)
+        {
+            const glm::vec2 pos{ boids.getPos(i) };
+            const glm::vec2 velocity{ boids.getVelocity(i) };
+            file << boids.id()[i] << ',' << pos.x << ',' << pos.y << ',' << velocity.x << ',' << velocity.y << ',' << boids.getHue(i) << '\n';
+        }
+
+        return static_cast<bool>(file);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::optional<Options> options{ parseOptions(argc, argv) };
+    if (!options)
+        return 1;
+    if (options->showHelp)
+    {
+        printUsage();
+        return 0;
+    }
+
+    if (!simulation::cpu::selectSimdKernel(options->simdLevel))
+        return 1;
+
+    const glm::vec2 worldSize{ options->worldWidth, options->worldHeight };
+    boid::globalVars::init(worldSize);
+    simulation::obstacle::init(worldSize);
+    fillParams(*options);
+    // Deterministic mode draws with deterministicSeed already, anything else with the seed picked at startup unless --seed
+    // replaces it
+    if (options->seed)
+        simulation::random::seed = *options->seed;
+
+    spawnBoids(options->params, options->numBoids);
+    if (options->bigCircleObstacle)
+        simulation::obstacle::makeBigCircleObstacle(worldSize);
+    // There's no real mouse, so the cursor sits in the middle of the world
+    if (options->params.avoidMouse)
+        simulation::input.cursorPos = worldSize / 2.0f;
+
+    std::cout << options->numBoids << " boids in a " << options->worldWidth << " x " << options->worldHeight << " world, "
+              << options->numSteps << " steps on " << options->params.numThreads << " threads\n";
+
+    const float deltaTime{ 1.0f / static_cast<float>(options->tickRate) };
+    const auto start{ std::chrono::steady_clock::now() };
+    for (int step{ 0 }; step < options->numSteps; ++step)
+        boid::BoidObject::updateBoids(options->params, deltaTime);
+    const double seconds{ std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() };
+
+    std::printf("%.1f steps/s (%.3f ms per step, %.1f simulated seconds)\n", options->numSteps / seconds,
+                seconds * 1000.0 / std::max(options->numSteps, 1), options->numSteps * deltaTime);
+    for (const simulation::TaskGraph::Timing& timing : boid::BoidObject::getStepTimings())
+        std::printf("  %s: %.3f ms average\n", timing.name, timing.averageMilliseconds);
+
+    if (options->params.deterministic)
+        std::printf("State hash after step %llu: %016llx\n", static_cast<unsigned long long>(boid::determinism::lastHashedStep),
+                    static_cast<unsigned long long>(boid::determinism::lastStateHash));
+
+    if (options->outputPath && !writeBoids(*options->outputPath))
+    {
+        std::cout << "Couldn't write " << *options->outputPath << "\n";
+        return 1;
+    }
+
+    return 0;
+}
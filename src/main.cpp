@@ -1,9 +1,12 @@
 #include "ShaderHandler.h"
+#include "Renderer.h"
 #include "Input.h"
 #include "simulation/boid/BoidObject.h"
 #include "simulation/boid/BoidParams.h"
 #include "simulation/obstacle/Obstacle.h"
-#include "simulation/UI.h"
+#include "UI.h"
+#include "simulation/CpuFeatures.h"
+#include "simulation/SimulationThread.h"
 #include "Camera.h"
 
 #include <GL/glew.h>
@@ -16,9 +19,32 @@
 #include "imgui_impl_opengl3.h"
 
 #include <iostream>
+#include <optional>
+#include <string_view>
 
-int main()
+namespace
 {
+    // --simd <level> (or --simd=<level>) on the command line
+    std::optional<std::string_view> getSimdArgument(int argc, char** argv)
+    {
+        for (int i{ 1 }; i < argc; ++i)
+        {
+            const std::string_view arg{ argv[i] };
+            if (arg == "--simd" && i + 1 < argc)
+                return argv[i + 1];
+            if (arg.starts_with("--simd="))
+                return arg.substr(std::string_view{ "--simd=" }.size());
+        }
+
+        return std::nullopt;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    // An unknown level has already been reported, and the app carries on with the best supported one
+    simulation::cpu::selectSimdKernel(getSimdArgument(argc, argv));
+
     glfwInit();
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
@@ -57,14 +83,16 @@ int main()
     ImGui_ImplOpenGL3_Init("#version 460");
     ImGui::GetIO().IniFilename = nullptr;
 
-    simulation::boid::globalVars::init();
-    simulation::obstacle::init();
+    // The world is the screen
+    const glm::vec2 worldSize{ Camera::screenWidth, Camera::screenHeight };
+    simulation::boid::globalVars::init(worldSize);
+    simulation::obstacle::init(worldSize);
+    Renderer::init();
     glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
     ShaderHandler::shaderProgram = ShaderHandler::compileShader(std::vector<std::string>{"../shaders/shader.vert", "../shaders/shader.frag"});
     glUseProgram(ShaderHandler::shaderProgram);
 
     bool showSettingsUI{ false };
-    float lastUpdateTime{ static_cast<float>(glfwGetTime()) };
 
 	// This is something I only needed to add after switching to Hyprland. The DPI scaling screws the mouse cursor
 	// pos up with glfwGetCursorPos(). This block calculates that scale factor so we can correct it.
@@ -90,6 +118,9 @@ int main()
 
     simulation::ui::cursors::initCursors(cursorScaleFactor);
 
+    simulation::simthread::publishParams(simulation::ui::getSimParams());
+    simulation::simthread::start();
+
     while (!glfwWindowShouldClose(window))
     {
         glfwPollEvents();
@@ -99,12 +130,13 @@ int main()
         ImGui_ImplGlfw_NewFrame();
         ImGui::NewFrame();
 
-        ImGuiIO& io{ ImGui::GetIO() };
+        // The only place the frame asks GLFW about the mouse and keyboard
+        const simulation::InputSnapshot input{ takeInputSnapshot(window, simulation::ui::cursors::cursorScaleFactor, ImGui::GetIO().WantCaptureMouse) };
 
-        if (processPressingSpace(window))
+        if (input.togglePlacingBoids)
             simulation::ui::placingBoids = !simulation::ui::placingBoids;
 
-        if (processPressingAlt(window))
+        if (input.toggleAvoidMouse)
         {
             simulation::ui::avoidMouse = !simulation::ui::avoidMouse;
             if (simulation::ui::avoidMouse)
@@ -113,42 +145,38 @@ int main()
                 glfwSetCursor(window, simulation::ui::cursors::whiteCursor);
         }
 
-        double xCursorPos, yCursorPos;
-        glfwGetCursorPos(window, &xCursorPos, &yCursorPos);
-		xCursorPos *= simulation::ui::cursors::cursorScaleFactor;
-		yCursorPos *= simulation::ui::cursors::cursorScaleFactor;
-        if (!io.WantCaptureMouse && processMouseInputClicking(window))
+        // Params go first so a click spawns with this frame's settings
+        simulation::simthread::publishParams(simulation::ui::getSimParams());
+        simulation::simthread::publishInput(input);
+        if (input.clicked)
         {
-            if (simulation::ui::placingBoids)
-                simulation::boid::BoidObject::createBoid({xCursorPos, yCursorPos});
-            else
-                simulation::obstacle::Obstacle::createObstacle({xCursorPos, yCursorPos});
+            using Type = simulation::simthread::Command::Type;
+            simulation::simthread::post({ simulation::ui::placingBoids ? Type::spawnBoids : Type::placeObstacle, input.cursorPos });
         }
 
-        // Handle boids
-        const float currentTime{ static_cast<float>(glfwGetTime()) };
-        const float deltaTime{ currentTime - lastUpdateTime };
-        lastUpdateTime = currentTime;
-        simulation::boid::BoidObject::updateBoids(deltaTime);
-        simulation::boid::BoidObject::renderAllBoids();
-        simulation::obstacle::Obstacle::renderAllObstacles();
+        // The boids get stepped on the simulation thread, this just draws the latest state it's published
+        const simulation::RenderSnapshot& snapshot{ simulation::simthread::acquireSnapshot() };
+        const double drawStart{ glfwGetTime() };
+        Renderer::renderBoids(snapshot, simulation::simthread::getInterpolationFactor(snapshot), simulation::ui::showVisionCones);
+        Renderer::renderObstacles(snapshot.obstacles);
+        simulation::ui::drawSubmissionMilliseconds = static_cast<float>((glfwGetTime() - drawStart) * 1000.0);
 
         // Show a translucent version of an obstacle where the cursor is if we're in the placing obstacles mode
         if (!simulation::ui::placingBoids)
         {
-            glBindVertexArray(simulation::obstacle::VAO);
+            glBindVertexArray(Renderer::obstacleVAO);
             glUniform3fv(glGetUniformLocation(ShaderHandler::shaderProgram, "color"), 1, glm::value_ptr(glm::vec3{ 0.5f, 0.0f, 0.0f }));
 
-            const glm::mat4 model{ glm::translate(glm::mat4{ 1.0f }, glm::vec3{ xCursorPos, yCursorPos, 0.0f }) };
+            const glm::mat4 model{ glm::translate(glm::mat4{ 1.0f }, glm::vec3{ input.cursorPos, 0.0f }) };
             glUniformMatrix4fv(glGetUniformLocation(ShaderHandler::shaderProgram, "mvp"), 1, GL_FALSE, glm::value_ptr(Camera::viewProjection * model));
-            glDrawArrays(GL_TRIANGLE_FAN, 0, simulation::obstacle::vertices.size());
+            glDrawArrays(GL_TRIANGLE_FAN, 0, Renderer::obstacleVertices.size());
         }
 
-        if (processPressingF1Key(window))
+        if (input.toggleSettings)
             showSettingsUI = !showSettingsUI;
 
         if (showSettingsUI)
-            simulation::ui::renderUI();
+            simulation::ui::renderUI(snapshot);
 
         ImGui::Render();
         ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
@@ -157,6 +185,8 @@ int main()
         glfwSwapBuffers(window);
     }
 
+    simulation::simthread::stop();
+
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
     ImGui::DestroyContext();
@@ -0,0 +1,75 @@
+#include "AlignedAllocator.h"
+
+#include <cstdint>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+namespace
+{
+    size_t roundUp(size_t value, size_t multiple)
+    {
+        return (value + multiple - 1) / multiple * multiple;
+    }
+}
+
+namespace simulation::hugepages
+{
+    std::atomic<size_t> mappedBytes{ 0 };
+    std::atomic<bool> lastWasExplicit{ false };
+
+#if defined(__linux__)
+    void* allocate(size_t bytes)
+    {
+        const size_t size{ roundUp(bytes, pageSize) };
+
+        // Explicit huge pages only exist if some were reserved up front, so this usually fails straight away
+        void* ptr{ mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0) };
+        lastWasExplicit = ptr != MAP_FAILED;
+        if (ptr == MAP_FAILED)
+        {
+            // Map an extra page's worth so the start can be moved up to a huge page boundary (transparent huge pages only
+            // get used for aligned 2 MB blocks), then give back what's left over on either side
+            const size_t paddedSize{ size + pageSize };
+            void* const padded{ mmap(nullptr, paddedSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0) };
+            if (padded == MAP_FAILED)
+                throw std::bad_alloc{};
+
+            const uintptr_t paddedStart{ reinterpret_cast<uintptr_t>(padded) };
+            const uintptr_t start{ roundUp(paddedStart, pageSize) };
+            if (start > paddedStart)
+                munmap(padded, start - paddedStart);
+            if (paddedStart + paddedSize > start + size)
+                munmap(reinterpret_cast<void*>(start + size), paddedStart + paddedSize - (start + size));
+
+            ptr = reinterpret_cast<void*>(start);
+
+            // Fails if transparent huge pages are turned off completely, in which case this is just a normal mapping
+            madvise(ptr, size, MADV_HUGEPAGE);
+        }
+
+        mappedBytes += size;
+        return ptr;
+    }
+
+    void deallocate(void* ptr, size_t bytes) noexcept
+    {
+        const size_t size{ roundUp(bytes, pageSize) };
+        munmap(ptr, size);
+        mappedBytes -= size;
+    }
+#else
+    void* allocate(size_t bytes)
+    {
+        mappedBytes += bytes;
+        return ::operator new(bytes, std::align_val_t{ pageSize });
+    }
+
+    void deallocate(void* ptr, size_t bytes) noexcept
+    {
+        ::operator delete(ptr, std::align_val_t{ pageSize });
+        mappedBytes -= bytes;
+    }
+#endif
+}
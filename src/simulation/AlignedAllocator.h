@@ -0,0 +1,62 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+
+namespace simulation
+{
+    // Big allocations get their own mapping instead of coming from the heap, so they can be backed by huge pages: 2 MB pages
+    // mean one TLB entry covers 512 times as much of the boid arrays, which matters once the hot loops sweep through
+    // several arrays of a million boids each step
+    namespace hugepages
+    {
+        // Allocations of at least this many bytes go through allocate() below
+        constexpr size_t pageSize{ size_t{ 2 } << 20 };
+
+        // Bytes currently mapped through allocate() (rounded up to whole huge pages), and whether the latest allocation got
+        // pages from the explicitly reserved pool (vm.nr_hugepages) rather than transparent huge pages. For the UI
+        extern std::atomic<size_t> mappedBytes;
+        extern std::atomic<bool> lastWasExplicit;
+
+        // Returns memory aligned to pageSize. On Linux this tries explicit huge pages (MAP_HUGETLB) first and falls back to
+        // an aligned mapping with madvise(MADV_HUGEPAGE). Elsewhere it's just an aligned operator new
+        void* allocate(size_t bytes);
+        // bytes has to be the same as what was passed to allocate()
+        void deallocate(void* ptr, size_t bytes) noexcept;
+    }
+
+    // Allocator for std::vector that aligns the storage to a cache line (or a full AVX-512 register). Anything of a huge
+    // page or more comes from hugepages::allocate instead, which is aligned to far more than Alignment anyway
+    template<typename T, size_t Alignment = 64>
+    struct AlignedAllocator
+    {
+        using value_type = T;
+
+        template<typename U>
+        struct rebind { using other = AlignedAllocator<U, Alignment>; };
+
+        AlignedAllocator() noexcept = default;
+        template<typename U>
+        AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept {}
+
+        T* allocate(size_t n)
+        {
+            if (n * sizeof(T) >= hugepages::pageSize)
+                return static_cast<T*>(hugepages::allocate(n * sizeof(T)));
+
+            return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t{ Alignment }));
+        }
+
+        void deallocate(T* ptr, size_t n) noexcept
+        {
+            if (n * sizeof(T) >= hugepages::pageSize)
+                hugepages::deallocate(ptr, n * sizeof(T));
+            else
+                ::operator delete(ptr, std::align_val_t{ Alignment });
+        }
+
+        template<typename U>
+        bool operator==(const AlignedAllocator<U, Alignment>&) const noexcept { return true; }
+    };
+}
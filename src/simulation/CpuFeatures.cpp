@@ -0,0 +1,115 @@
+#include "CpuFeatures.h"
+#include "boid/FlockKernel.h"
+
+#include <cstdlib>
+#include <iostream>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+namespace
+{
+    using simulation::cpu::SimdLevel;
+
+    SimdLevel detectSimdLevel()
+    {
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+        // These also check that the OS saves the wider registers on context switches
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f"))
+            return SimdLevel::avx512;
+        if (__builtin_cpu_supports("avx2"))
+            return SimdLevel::avx2;
+        if (__builtin_cpu_supports("sse4.2") && __builtin_cpu_supports("popcnt"))
+            return SimdLevel::sse42;
+
+        return SimdLevel::scalar;
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+        int info[4];
+        __cpuid(info, 1);
+        const bool sse42{ (info[2] & (1 << 20)) != 0 && (info[2] & (1 << 23)) != 0 };
+        const bool osSavesRegisters{ (info[2] & (1 << 27)) != 0 };
+        const bool avx{ (info[2] & (1 << 28)) != 0 };
+
+        // XCR0 says which register sets the OS saves: bits 1-2 for SSE/AVX, 5-7 for the AVX-512 mask and upper registers
+        const unsigned long long xcr0{ osSavesRegisters ? _xgetbv(0) : 0 };
+        __cpuidex(info, 7, 0);
+        if (avx && (info[1] & (1 << 16)) != 0 && (xcr0 & 0xE6) == 0xE6)
+            return SimdLevel::avx512;
+        if (avx && (info[1] & (1 << 5)) != 0 && (xcr0 & 0x6) == 0x6)
+            return SimdLevel::avx2;
+        if (sse42)
+            return SimdLevel::sse42;
+
+        return SimdLevel::scalar;
+#else
+        return SimdLevel::scalar;
+#endif
+    }
+}
+
+simulation::cpu::SimdLevel simulation::cpu::getSupportedSimdLevel()
+{
+    static const SimdLevel level{ detectSimdLevel() };
+    return level;
+}
+
+std::optional<simulation::cpu::SimdLevel> simulation::cpu::parseSimdLevel(std::string_view name)
+{
+    if (name == "scalar")
+        return SimdLevel::scalar;
+    if (name == "sse4.2")
+        return SimdLevel::sse42;
+    if (name == "avx2")
+        return SimdLevel::avx2;
+    if (name == "avx512")
+        return SimdLevel::avx512;
+
+    return std::nullopt;
+}
+
+const char* simulation::cpu::getSimdLevelName(SimdLevel level)
+{
+    switch (level)
+    {
+        case SimdLevel::scalar : return "scalar";
+        case SimdLevel::sse42 : return "SSE4.2";
+        case SimdLevel::avx2 : return "AVX2";
+        case SimdLevel::avx512 : return "AVX-512";
+    }
+
+    return "scalar";
+}
+
+bool simulation::cpu::selectSimdKernel(std::optional<std::string_view> argument)
+{
+    const SimdLevel supported{ getSupportedSimdLevel() };
+    SimdLevel requested{ supported };
+    bool known{ true };
+
+    if (!argument)
+    {
+        if (const char* env{ std::getenv("BOIDS_SIMD") })
+            argument = env;
+    }
+
+    if (argument)
+    {
+        if (const std::optional<SimdLevel> level{ parseSimdLevel(*argument) })
+            requested = *level;
+        else
+        {
+            std::cout << "Unknown SIMD level \"" << *argument << "\" (expected scalar, sse4.2, avx2 or avx512)\n";
+            known = false;
+        }
+    }
+
+    const SimdLevel selected{ boid::kernel::setSimdLevel(requested) };
+    if (selected != requested)
+        std::cout << "This CPU doesn't support " << getSimdLevelName(requested) << "\n";
+
+    std::cout << "Neighbor kernel: " << getSimdLevelName(selected) << " (CPU supports up to " << getSimdLevelName(supported) << ")\n";
+    return known;
+}
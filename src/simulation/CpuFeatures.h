@@ -0,0 +1,31 @@
+#pragma once
+
+#include <optional>
+#include <string_view>
+
+// Which SIMD instruction sets the CPU running the program has. The build only assumes the baseline for the target
+// (SSE2 on x86-64), so the kernels that need more get compiled for their own instruction set and picked at startup
+namespace simulation::cpu
+{
+    // In increasing order, every level includes the ones before it
+    enum class SimdLevel
+    {
+        scalar,
+        sse42,
+        avx2,
+        avx512,
+    };
+
+    // The best level this CPU (and OS) supports that the kernels were also compiled for
+    SimdLevel getSupportedSimdLevel();
+
+    // "scalar", "sse4.2", "avx2" or "avx512" (case sensitive). Anything else gives nullopt
+    std::optional<SimdLevel> parseSimdLevel(std::string_view name);
+    const char* getSimdLevelName(SimdLevel level);
+
+    // Picks the neighbor kernel at startup: the level from the command line (argument, from --simd), or else the
+    // BOIDS_SIMD environment variable, or else the best one the CPU supports. Logs the kernel it ended up with, and when
+    // the CPU can't run the level asked for and it got lowered. Returns false if the name asked for isn't a level, in which
+    // case the best supported one gets used
+    bool selectSimdKernel(std::optional<std::string_view> argument);
+}
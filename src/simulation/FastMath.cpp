@@ -0,0 +1,68 @@
+#include "FastMath.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    constexpr int numSamples{ 1 << 20 };
+
+    // Evenly spaced samples over [min, max]
+    template<typename Func>
+    void sweep(double min, double max, const Func& func)
+    {
+        for (int i{ 0 }; i <= numSamples; ++i)
+            func(min + (max - min) * i / numSamples);
+    }
+}
+
+namespace simulation::fastmath
+{
+    ErrorStats measureErrors()
+    {
+        ErrorStats errors{};
+        const auto track{ [](float& worst, double error) { worst = std::max(worst, static_cast<float>(error)); } };
+
+        // Geometric sweep, so every exponent gets the same number of samples
+        sweep(std::log(1e-6), std::log(1e6), [&](double logX)
+        {
+            const float x{ static_cast<float>(std::exp(logX)) };
+            const double exact{ 1.0 / std::sqrt(static_cast<double>(x)) };
+            track(errors.rsqrtRelative, std::abs(approx::rsqrt(x) - exact) / exact);
+        });
+
+        sweep(-1e4, 1e4, [&](double value)
+        {
+            const float angle{ static_cast<float>(value) };
+            float sin, cos;
+            approx::sincos(angle, sin, cos);
+            track(errors.sinCosAbsolute, std::abs(sin - std::sin(static_cast<double>(angle))));
+            track(errors.sinCosAbsolute, std::abs(cos - std::cos(static_cast<double>(angle))));
+        });
+
+        // Around the circle at a few different scales, plus the axes and the origin
+        sweep(-4.0, 4.0, [&](double angle)
+        {
+            for (const double radius : { 1e-3, 1.0, 1e3 })
+            {
+                const float x{ static_cast<float>(std::cos(angle) * radius) };
+                const float y{ static_cast<float>(std::sin(angle) * radius) };
+                track(errors.atan2Absolute, std::abs(approx::atan2(y, x) - std::atan2(static_cast<double>(y), static_cast<double>(x))));
+            }
+        });
+        for (const float x : { -1.0f, 0.0f, 1.0f })
+            for (const float y : { -1.0f, 0.0f, 1.0f })
+                track(errors.atan2Absolute, std::abs(approx::atan2(y, x) - std::atan2(static_cast<double>(y), static_cast<double>(x))));
+
+        sweep(-3.0, 3.0, [&](double value)
+        {
+            const float x{ static_cast<float>(value) };
+            const double exact{ static_cast<double>(x) - std::floor(static_cast<double>(x)) };
+            // 0 and 1 are the same place on the hue wheel
+            const double error{ std::abs(approx::wrap(x, 1.0f) - exact) };
+            track(errors.wrapAbsolute, std::min(error, 1.0 - error));
+        });
+
+        return errors;
+    }
+}
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+
+// Cheaper stand-ins for the standard math functions the per-boid hot paths call. The approximations are plain float
+// arithmetic with selects instead of branches (no table lookups, no calls into libm), so loops over them can get
+// vectorized, and each one lists its worst case error as measured against the double precision standard library
+// function over its whole input range (measureErrors() redoes the measurement, and tests/FastMathTest.cpp checks it
+// against the bounds listed here).
+//
+// The functions outside of approx pick between the standard library and the approximation based on the precision they
+// get passed (SimParams::precision for the step). Exact is the default, and fast trades those errors for skipping the libm
+// calls and the divides and square roots
+namespace simulation::fastmath
+{
+    enum class Precision
+    {
+        exact,
+        fast,
+    };
+
+    namespace approx
+    {
+        // 1 / sqrt(x) for x > 0 (normal floats). Relative error under 5e-6: the bit trick initial guess refined with two
+        // Newton steps
+        inline float rsqrt(float x)
+        {
+            float y{ std::bit_cast<float>(0x5f375a86u - (std::bit_cast<uint32_t>(x) >> 1)) };
+            y *= 1.5f - 0.5f * x * y * y;
+            y *= 1.5f - 0.5f * x * y * y;
+            return y;
+        }
+
+        // Both sin and cos of angle. Absolute error under 2e-7 for |angle| up to 1e4 (past that the range reduction starts
+        // losing bits, like any float version would). The angle gets reduced to [-pi/4, pi/4] plus a quadrant and both
+        // come from short Taylor polynomials
+        inline void sincos(float angle, float& sin, float& cos)
+        {
+            constexpr float twoOverPi{ 0.636619772f };
+            // pi/2 split in two so quadrant * piOverTwoHigh is exact for quadrants up to 2^16
+            constexpr float piOverTwoHigh{ 1.5703125f };
+            constexpr float piOverTwoLow{ 4.83826794897e-4f };
+
+            // Rounded with a conversion to int rather than nearbyint, which needs SSE4.1 to not be a libm call
+            const int quadrantIndex{ static_cast<int>(angle * twoOverPi + (angle < 0.0f ? -0.5f : 0.5f)) };
+            const float quadrant{ static_cast<float>(quadrantIndex) };
+            const float x{ (angle - quadrant * piOverTwoHigh) - quadrant * piOverTwoLow };
+            const float x2{ x * x };
+
+            const float s{ x + x * x2 * (-1.0f / 6.0f + x2 * (1.0f / 120.0f + x2 * (-1.0f / 5040.0f + x2 * (1.0f / 362880.0f)))) };
+            const float c{ 1.0f + x2 * (-0.5f + x2 * (1.0f / 24.0f + x2 * (-1.0f / 720.0f + x2 * (1.0f / 40320.0f)))) };
+
+            // Quadrant 1 and 3 swap sin and cos, 2 and 3 flip the sign of sin, 1 and 2 flip the sign of cos
+            const int q{ quadrantIndex & 3 };
+            const float swappedSin{ (q & 1) ? c : s };
+            const float swappedCos{ (q & 1) ? s : c };
+            sin = (q & 2) ? -swappedSin : swappedSin;
+            cos = ((q + 1) & 2) ? -swappedCos : swappedCos;
+        }
+
+        // atan2(y, x) in [-pi, pi], with atan2(0, 0) = 0. Absolute error under 3e-6 radians. The smaller of |x| and |y| over
+        // the bigger one goes through a minimax polynomial for atan on [0, 1] and then gets mirrored into the right octant
+        inline float atan2(float y, float x)
+        {
+            const float absX{ std::abs(x) };
+            const float absY{ std::abs(y) };
+            const float bigger{ std::max(absX, absY) };
+            const float a{ bigger > 0.0f ? std::min(absX, absY) / bigger : 0.0f };
+            const float a2{ a * a };
+
+            float angle{ a * (0.99997726f + a2 * (-0.33262347f + a2 * (0.19354346f + a2 * (-0.11643287f + a2 * (0.05265332f + a2 * -0.01172120f))))) };
+            angle = absY > absX ? 1.57079637f - angle : angle;
+            angle = x < 0.0f ? 3.14159274f - angle : angle;
+            return std::signbit(y) ? -angle : angle;
+        }
+
+        // x wrapped into [0, period), for |x / period| under 2^31. No error past the rounding of x - n * period (none at all
+        // for the hues, which stay within a few periods of 0)
+        inline float wrap(float x, float period)
+        {
+            // floor through a conversion to int, for the same reason as in sincos
+            const float ratio{ x / period };
+            float periods{ static_cast<float>(static_cast<int>(ratio)) };
+            periods -= periods > ratio ? 1.0f : 0.0f;
+
+            const float wrapped{ x - periods * period };
+            return wrapped < period ? wrapped : 0.0f;
+        }
+    }
+
+    inline float rsqrt(Precision precision, float x)
+    {
+        return precision == Precision::fast ? approx::rsqrt(x) : 1.0f / std::sqrt(x);
+    }
+
+    inline void sincos(Precision precision, float angle, float& sin, float& cos)
+    {
+        if (precision == Precision::fast)
+        {
+            approx::sincos(angle, sin, cos);
+            return;
+        }
+
+        sin = std::sin(angle);
+        cos = std::cos(angle);
+    }
+
+    inline float atan2(Precision precision, float y, float x)
+    {
+        return precision == Precision::fast ? approx::atan2(y, x) : std::atan2(y, x);
+    }
+
+    // The exact version is the same fmod(x + period, period) the hue code used, which only works for x > -period
+    inline float wrap(Precision precision, float x, float period)
+    {
+        return precision == Precision::fast ? approx::wrap(x, period) : std::fmod(x + period, period);
+    }
+
+    inline float length(Precision precision, glm::vec2 v)
+    {
+        if (precision != Precision::fast)
+            return glm::length(v);
+
+        const float lengthSquared{ glm::dot(v, v) };
+        return lengthSquared > 0.0f ? lengthSquared * approx::rsqrt(lengthSquared) : 0.0f;
+    }
+
+    // Like glm::normalize, v can't be zero
+    inline glm::vec2 normalize(Precision precision, glm::vec2 v)
+    {
+        return precision == Precision::fast ? v * approx::rsqrt(glm::dot(v, v)) : glm::normalize(v);
+    }
+
+    // Worst case errors of the approximations against the standard library, measured over a sweep of their inputs
+    struct ErrorStats
+    {
+        float rsqrtRelative{ 0.0f };
+        float sinCosAbsolute{ 0.0f };
+        float atan2Absolute{ 0.0f };
+        float wrapAbsolute{ 0.0f };
+    };
+
+    ErrorStats measureErrors();
+}
@@ -0,0 +1,55 @@
+#include "FixedTimestep.h"
+#include "boid/BoidObject.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace
+{
+    float accumulator{ 0.0f };
+}
+
+namespace simulation::timestep
+{
+    int stepsLastFrame{ 0 };
+    float droppedTime{ 0.0f };
+    float lastStepMilliseconds{ 0.0f };
+
+    int advance(const SimParams& params, float frameTime)
+    {
+        const float stepSize{ getStepSize(params) };
+        accumulator += std::max(frameTime, 0.0f);
+
+        int numSteps{ 0 };
+        while (accumulator >= stepSize && numSteps < params.maxStepsPerFrame)
+        {
+            const auto stepStart{ std::chrono::steady_clock::now() };
+            boid::BoidObject::updateBoids(params, stepSize);
+            lastStepMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - stepStart).count();
+            accumulator -= stepSize;
+            ++numSteps;
+        }
+
+        // Couldn't keep up, so let the simulation fall behind real time instead of trying to catch up next frame
+        if (accumulator >= stepSize)
+        {
+            const float kept{ std::fmod(accumulator, stepSize) };
+            droppedTime += accumulator - kept;
+            accumulator = kept;
+        }
+
+        stepsLastFrame = numSteps;
+        return numSteps;
+    }
+
+    float getInterpolationFactor(const SimParams& params)
+    {
+        return std::clamp(accumulator / getStepSize(params), 0.0f, 1.0f);
+    }
+
+    float getStepSize(const SimParams& params)
+    {
+        return 1.0f / static_cast<float>(std::max(params.simulationTickRate, 1));
+    }
+}
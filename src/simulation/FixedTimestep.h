@@ -0,0 +1,27 @@
+#pragma once
+
+#include "SimParams.h"
+
+// Runs updateBoids in fixed steps of 1 / params.simulationTickRate seconds instead of whatever the last frame took, so a
+// hitch (moving the window, spawning a big group) can't turn into one huge step that sends boids through obstacles.
+//
+// The frame time goes into an accumulator and as many whole steps as fit get run, up to params.maxStepsPerFrame. If even
+// that can't keep up, the backlog gets dropped rather than carried over, otherwise every frame would have more to catch
+// up on than the last (the spiral of death). Whatever is left over (less than a step) is how far between the last two
+// states the boids get drawn
+namespace simulation::timestep
+{
+    // For the UI
+    extern int stepsLastFrame;
+    extern float droppedTime;
+    extern float lastStepMilliseconds;
+
+    // Runs the steps for a frame that took frameTime seconds with params and returns how many it ran
+    int advance(const SimParams& params, float frameTime);
+
+    // How far (0 to 1) the current time is between the last two steps
+    float getInterpolationFactor(const SimParams& params);
+
+    // Seconds per step at params' tick rate
+    float getStepSize(const SimParams& params);
+}
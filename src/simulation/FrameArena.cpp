@@ -0,0 +1,57 @@
+#include "FrameArena.h"
+
+#include <algorithm>
+
+namespace
+{
+    size_t alignUp(size_t value)
+    {
+        return (value + simulation::FrameArena::alignment - 1) / simulation::FrameArena::alignment * simulation::FrameArena::alignment;
+    }
+
+    // Room to grow on top of the high water mark, so a flock that's still growing doesn't reallocate the block every step
+    constexpr size_t growthFactorPercent{ 150 };
+}
+
+namespace simulation
+{
+    FrameArena frameArena{};
+
+    void* FrameArena::allocateBytes(size_t bytes)
+    {
+        bytes = alignUp(std::max<size_t>(bytes, 1));
+        if (m_used + bytes <= m_block.size())
+        {
+            void* const ptr{ m_block.data() + m_used };
+            m_used += bytes;
+            return ptr;
+        }
+
+        // Doesn't fit in the block. Anything already handed out this step has to stay put, so this one gets its own
+        // allocation and the block grows at the next reset
+        ++m_heapAllocations;
+        m_overflowBytes += bytes;
+        return m_overflow.emplace_back(bytes).data();
+    }
+
+    void FrameArena::reset()
+    {
+        const size_t usedThisStep{ m_used + m_overflowBytes };
+        m_highWaterMark = std::max(m_highWaterMark, usedThisStep);
+
+        if (usedThisStep > m_block.size())
+        {
+            // Free the old block first so the peak memory use doesn't include both
+            m_block = Block{};
+            m_block.resize(alignUp(usedThisStep * growthFactorPercent / 100));
+            ++m_heapAllocations;
+        }
+
+        m_overflow.clear();
+        m_overflowBytes = 0;
+        m_used = 0;
+
+        m_heapAllocationsLastStep = m_heapAllocations;
+        m_heapAllocations = 0;
+    }
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "AlignedAllocator.h"
+
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+namespace simulation
+{
+    // Linear allocator for the scratch buffers that only live for one step of the simulation. Allocating just bumps an
+    // offset into one block, and reset() at the end of the step hands everything back at once.
+    //
+    // If a step needs more than the block holds, the rest comes from the heap for that step and the block gets grown to
+    // fit at the next reset(), so once the flock stops growing a step doesn't touch the heap at all. The block comes from
+    // AlignedAllocator, so past 2 MB it's backed by huge pages.
+    //
+    // Not thread safe: allocate from the thread running updateBoids (before handing the buffers to the thread pool)
+    class FrameArena
+    {
+        public:
+            // Every allocation starts on a cache line
+            static constexpr size_t alignment{ 64 };
+
+            // Uninitialized storage for count Ts, valid until the next reset()
+            template<typename T>
+            T* allocate(size_t count)
+            {
+                static_assert(std::is_trivially_destructible_v<T> && alignof(T) <= alignment);
+                return static_cast<T*>(allocateBytes(count * sizeof(T)));
+            }
+
+            void reset();
+
+            size_t getCapacity() const { return m_block.size(); }
+            // The most a single step has used so far
+            size_t getHighWaterMark() const { return m_highWaterMark; }
+            // Heap allocations (overflow and growing the block) made during the last step that got reset
+            int getHeapAllocationsLastStep() const { return m_heapAllocationsLastStep; }
+
+        private:
+            using Block = std::vector<std::byte, AlignedAllocator<std::byte, alignment>>;
+
+            Block m_block{};
+            size_t m_used{ 0 };
+            size_t m_highWaterMark{ 0 };
+
+            std::vector<Block> m_overflow{};
+            size_t m_overflowBytes{ 0 };
+
+            int m_heapAllocations{ 0 };
+            int m_heapAllocationsLastStep{ 0 };
+
+            void* allocateBytes(size_t bytes);
+    };
+
+    extern FrameArena frameArena;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+
+// IEEE 754 half precision (1 sign bit, 5 exponent bits, 10 mantissa bits) packed into a uint16_t, for state that can live
+// with about 3 significant digits. The conversions are plain integer and float arithmetic so they work without F16C, and
+// round to nearest even like the hardware ones do
+namespace simulation::halffloat
+{
+    // Values past the half range (65504) become infinity and NaNs stay NaNs
+    inline uint16_t fromFloat(float value)
+    {
+        constexpr uint32_t floatInfinity{ 255u << 23 };
+        constexpr uint32_t halfOverflow{ (127u + 16u) << 23 };
+        constexpr uint32_t smallestNormal{ 113u << 23 };
+        // Adding this pushes a subnormal half's mantissa down into the low bits of the float, where the float addition
+        // does the rounding for us
+        constexpr float subnormalMagic{ std::bit_cast<float>(((127u - 15u) + (23u - 10u) + 1u) << 23) };
+
+        uint32_t bits{ std::bit_cast<uint32_t>(value) };
+        const uint32_t sign{ bits & 0x80000000u };
+        bits ^= sign;
+
+        uint16_t half;
+        if (bits >= halfOverflow)
+            half = bits > floatInfinity ? 0x7e00 : 0x7c00;
+        else if (bits < smallestNormal)
+            half = static_cast<uint16_t>(std::bit_cast<uint32_t>(std::bit_cast<float>(bits) + subnormalMagic) - std::bit_cast<uint32_t>(subnormalMagic));
+        else
+        {
+            // Rebias the exponent, then round: 0xfff rounds halfway cases down and adding the lowest kept mantissa bit
+            // turns that into rounding them to even
+            const uint32_t mantissaOdd{ (bits >> 13) & 1u };
+            bits += (static_cast<uint32_t>(15 - 127) << 23) + 0xfffu;
+            bits += mantissaOdd;
+            half = static_cast<uint16_t>(bits >> 13);
+        }
+
+        return static_cast<uint16_t>(half | (sign >> 16));
+    }
+
+    // Exact, every half is a float
+    inline float toFloat(uint16_t half)
+    {
+        constexpr uint32_t shiftedExponent{ 0x7c00u << 13 };
+        constexpr float subnormalMagic{ std::bit_cast<float>(113u << 23) };
+
+        uint32_t bits{ (half & 0x7fffu) << 13 };
+        const uint32_t exponent{ bits & shiftedExponent };
+        bits += (127u - 15u) << 23;
+
+        if (exponent == shiftedExponent)
+            bits += (128u - 16u) << 23; // Infinity or NaN
+        else if (exponent == 0)
+        {
+            bits += 1u << 23; // Zero or subnormal, renormalized by the float subtraction
+            bits = std::bit_cast<uint32_t>(std::bit_cast<float>(bits) - subnormalMagic);
+        }
+
+        return std::bit_cast<float>(bits | ((half & 0x8000u) << 16));
+    }
+}
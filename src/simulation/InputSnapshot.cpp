@@ -0,0 +1,6 @@
+#include "InputSnapshot.h"
+
+namespace simulation
+{
+    InputSnapshot input{};
+}
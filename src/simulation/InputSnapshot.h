@@ -0,0 +1,23 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+namespace simulation
+{
+    // Everything a frame needs from the mouse and keyboard, read from GLFW once at the start of the frame (see
+    // takeInputSnapshot in Input.h) so nothing else has to ask the window system. The click and the keys are edges, so
+    // they're only true on the frame the button or key went down
+    struct InputSnapshot
+    {
+        // Already corrected for the DPI scaling
+        glm::vec2 cursorPos{ 0.0f };
+        // A left click ImGui didn't take
+        bool clicked{ false };
+        bool togglePlacingBoids{ false };
+        bool toggleAvoidMouse{ false };
+        bool toggleSettings{ false };
+    };
+
+    // The newest snapshot the simulation has picked up. Only whichever thread runs updateBoids may touch it
+    extern InputSnapshot input;
+}
@@ -0,0 +1,100 @@
+#include "Random.h"
+
+#include <algorithm>
+#include <random>
+
+namespace
+{
+    using Words = std::array<uint32_t, 4>;
+
+    // Round multipliers and key increments from the Philox paper
+    constexpr uint32_t multiplier0{ 0xD2511F53 };
+    constexpr uint32_t multiplier1{ 0xCD9E8D57 };
+    constexpr uint32_t keyIncrement0{ 0x9E3779B9 };
+    constexpr uint32_t keyIncrement1{ 0xBB67AE85 };
+    constexpr int numRounds{ 10 };
+
+    // Lanes per batch in fillCentered
+    constexpr size_t batchSize{ 64 };
+
+    uint64_t makeSeed()
+    {
+        std::random_device device{};
+        return (static_cast<uint64_t>(device()) << 32) | device();
+    }
+
+    Words philox(Words counter, uint64_t key)
+    {
+        uint32_t key0{ static_cast<uint32_t>(key) };
+        uint32_t key1{ static_cast<uint32_t>(key >> 32) };
+
+        for (int round{ 0 }; round < numRounds; ++round)
+        {
+            const uint64_t product0{ static_cast<uint64_t>(multiplier0) * counter[0] };
+            const uint64_t product1{ static_cast<uint64_t>(multiplier1) * counter[2] };
+            counter = Words{
+                static_cast<uint32_t>(product1 >> 32) ^ counter[1] ^ key0,
+                static_cast<uint32_t>(product1),
+                static_cast<uint32_t>(product0 >> 32) ^ counter[3] ^ key1,
+                static_cast<uint32_t>(product0)
+            };
+
+            key0 += keyIncrement0;
+            key1 += keyIncrement1;
+        }
+
+        return counter;
+    }
+
+    Words makeCounter(simulation::random::Stream stream, uint32_t id, uint64_t counter)
+    {
+        return { id, static_cast<uint32_t>(stream), static_cast<uint32_t>(counter), static_cast<uint32_t>(counter >> 32) };
+    }
+
+    // The top 24 bits fit in a float's mantissa exactly, so every value in [-1, 1) on a 2^-23 grid is equally likely
+    float toCentered(uint32_t word)
+    {
+        return static_cast<float>(word >> 8) * (1.0f / (1 << 23)) - 1.0f;
+    }
+}
+
+namespace simulation::random
+{
+    uint64_t seed{ makeSeed() };
+}
+
+std::array<uint32_t, 4> simulation::random::draw(uint64_t seed, Stream stream, uint32_t id, uint64_t counter)
+{
+    return philox(makeCounter(stream, id, counter), seed);
+}
+
+std::array<float, 4> simulation::random::drawCentered(uint64_t seed, Stream stream, uint32_t id, uint64_t counter)
+{
+    const Words words{ draw(seed, stream, id, counter) };
+    return { toCentered(words[0]), toCentered(words[1]), toCentered(words[2]), toCentered(words[3]) };
+}
+
+void simulation::random::fillCentered(uint64_t seed, Stream stream, uint64_t counter, const uint32_t* ids, size_t count, const std::array<float*, 4>& outputs)
+{
+    std::array<std::array<uint32_t, batchSize>, 4> words;
+
+    for (size_t batchBegin{ 0 }; batchBegin < count; batchBegin += batchSize)
+    {
+        const size_t numLanes{ std::min(batchSize, count - batchBegin) };
+        for (size_t lane{ 0 }; lane < numLanes; ++lane)
+        {
+            const Words result{ philox(makeCounter(stream, ids[batchBegin + lane], counter), seed) };
+            for (size_t word{ 0 }; word < 4; ++word)
+                words[word][lane] = result[word];
+        }
+
+        for (size_t word{ 0 }; word < 4; ++word)
+        {
+            if (outputs[word] == nullptr)
+                continue;
+
+            for (size_t lane{ 0 }; lane < numLanes; ++lane)
+                outputs[word][batchBegin + lane] = toCentered(words[word][lane]);
+        }
+    }
+}
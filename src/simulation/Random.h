@@ -0,0 +1,37 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Counter-based random numbers (Philox4x32-10, from Salmon et al., "Parallel random numbers: as easy as 1, 2, 3").
+// Instead of stepping a shared generator, every draw is a pure function of the seed and a counter made of what the
+// number is for (the stream), which boid it's for and which step (or draw) it is. That means any thread can draw any
+// boid's numbers in any order and still get the same ones, so the draws can be split up between threads and vectorized,
+// and the simulation doesn't depend on how the work got chunked
+namespace simulation::random
+{
+    // Picked at startup from std::random_device. Changing it gives a different (but still reproducible) simulation. The
+    // draws take their seed as an argument, so this is only the default that getSeed (SimParams.h) hands out outside of
+    // deterministic mode
+    extern uint64_t seed;
+
+    // What the numbers are for, so the same boid and step can draw separate numbers for separate things
+    enum class Stream : uint32_t
+    {
+        stepNoise,
+        spawn,
+        hues,
+    };
+
+    // 4 independent uniformly distributed 32-bit words
+    std::array<uint32_t, 4> draw(uint64_t seed, Stream stream, uint32_t id, uint64_t counter);
+
+    // 4 floats uniformly distributed in [-1, 1)
+    std::array<float, 4> drawCentered(uint64_t seed, Stream stream, uint32_t id, uint64_t counter);
+
+    // Batched drawCentered for ids[0] to ids[count - 1]: outputs[j][i] = drawCentered(seed, stream, ids[i], counter)[j].
+    // Outputs that are nullptr get skipped. The lanes are independent and branch free, so the compiler vectorizes the Philox
+    // rounds
+    void fillCentered(uint64_t seed, Stream stream, uint64_t counter, const uint32_t* ids, size_t count, const std::array<float*, 4>& outputs);
+}
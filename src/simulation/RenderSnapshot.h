@@ -0,0 +1,72 @@
+#pragma once
+
+#include "boid/FarField.h"
+#include "boid/FlockStats.h"
+#include "TaskGraph.h"
+
+#include <glm/glm.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace simulation
+{
+    // The numbers the UI shows about the simulation, copied out along with each snapshot so the UI never reads the
+    // simulation's own state while a step could be running
+    struct SimulationStats
+    {
+        int stepsLastFrame{ 0 };
+        float droppedTime{ 0.0f };
+        float lastStepMilliseconds{ 0.0f };
+        // Each node of the latest step, and filling in this snapshot
+        std::vector<TaskGraph::Timing> stepTimings{};
+        float instanceFillMilliseconds{ 0.0f };
+
+        size_t arenaCapacity{ 0 };
+        size_t arenaHighWaterMark{ 0 };
+        int arenaHeapAllocations{ 0 };
+        size_t bytesPerBoid{ 0 };
+
+        bool ghostCellsAvailable{ false };
+        size_t numGhosts{ 0 };
+        float ghostRebuildMilliseconds{ 0.0f };
+        size_t ghostMemoryUsage{ 0 };
+
+        bool symmetricPassAvailable{ false };
+
+        float mortonLocality{ 0.0f };
+        float mortonLocalityAfterLastReorder{ 0.0f };
+
+        boid::farfield::ErrorStats farFieldError{};
+        std::optional<boid::flockstats::Stats> flockStats{};
+
+        uint64_t stateHash{ 0 };
+        uint64_t hashedStep{ 0 };
+    };
+
+    // Everything the render loop needs from one simulation step, in the store's order. Colors are RGB and rotations are
+    // in radians, both worked out on the simulation thread so drawing is just reading them
+    struct RenderSnapshot
+    {
+        std::vector<glm::vec2> positions{};
+        std::vector<glm::vec2> prevPositions{};
+        std::vector<float> rotations{};
+        std::vector<glm::vec3> colors{};
+        std::vector<glm::vec2> obstacles{};
+        // The size of the world the positions are in, so the renderer knows when a boid has wrapped around it
+        glm::vec2 worldSize{ 0.0f };
+
+        // How far between the last two steps the simulation was when this got published, and when that was. The render
+        // loop carries on from there at stepSize per step so motion stays smooth between snapshots
+        float interpolation{ 1.0f };
+        float stepSize{ 1.0f };
+        std::chrono::steady_clock::time_point publishTime{};
+
+        SimulationStats stats{};
+
+        size_t size() const { return positions.size(); }
+    };
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "FastMath.h"
+#include "Random.h"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+
+namespace simulation
+{
+    // Everything the simulation reads that the UI can change. The UI keeps its own copies of these (the ui:: globals and
+    // globalVars) and hands a fresh SimParams to the simulation thread every frame (see SimulationThread.h), so the two
+    // threads never share a variable that one of them writes. The defaults match the UI's. Anything else driving the
+    // simulation (like boids_headless) fills one in itself and passes it to updateBoids, which hands it on to every module
+    // the step is split across
+    struct SimParams
+    {
+        // The world is worldSize.x by worldSize.y with the origin in the top left, and wraps around at the edges. The app
+        // uses the screen size
+        glm::vec2 worldSize{ 0.0f };
+        // How far past an edge a boid goes before it wraps to the other side. The app uses the triangle's height so a boid
+        // is completely off screen before it reappears
+        float wrapMargin{ 0.0f };
+
+        // Flocking. The forces and speed are already scaled by the world size (see globalVars::init)
+        float separation{ 0.0f };
+        float alignment{ 0.0f };
+        float cohesion{ 0.0f };
+        float maxSpeed{ 0.0f };
+        float visionRadius{ 0.0f };
+        float visionAngleCos{ -0.707106781f };
+        bool blendHues{ true };
+        bool topologicalNeighbors{ false };
+        int topologicalNeighborCount{ 7 };
+        bool farFieldAggregates{ false };
+        float farFieldOpeningAngle{ 0.5f };
+
+        // Colors the render snapshots get
+        float saturation{ 90.0f / 255.0f };
+        float brightness{ 200.0f / 255.0f };
+
+        // Obstacles and the mouse
+        float obstacleRadius{ 0.0f };
+        bool avoidMouse{ false };
+        float avoidMouseScale{ 1.0f };
+
+        // What a click spawns
+        int numBoidsPerClick{ 1 };
+        bool randomizeGroupBoidPositions{ false };
+        bool groupBoidsPointInSameDir{ true };
+        bool groupBoidsShareSameHue{ false };
+
+        // Performance
+        int simulationTickRate{ 120 };
+        int maxStepsPerFrame{ 4 };
+        int numThreads{ 1 };
+        bool useSimdKernel{ true };
+        fastmath::Precision precision{ fastmath::Precision::exact };
+        bool cullNeighborCells{ true };
+        bool ghostCells{ true };
+        bool symmetricPairs{ false };
+        bool mortonReorder{ false };
+        int mortonReorderInterval{ 60 };
+        int flockUpdateInterval{ 1 };
+        bool compactBoidState{ false };
+        bool deterministic{ false };
+        uint64_t deterministicSeed{ 1 };
+    };
+
+    // The seed the random draws use with these params: the fixed one in deterministic mode, the one picked at startup
+    // otherwise
+    inline uint64_t getSeed(const SimParams& params)
+    {
+        return params.deterministic ? params.deterministicSeed : random::seed;
+    }
+}
@@ -0,0 +1,208 @@
+#include "SimulationThread.h"
+#include "TripleBuffer.h"
+#include "SpscQueue.h"
+#include "FixedTimestep.h"
+#include "FrameArena.h"
+#include "boid/BoidObject.h"
+#include "boid/BoidParams.h"
+#include "boid/MortonOrder.h"
+#include "boid/SymmetricPass.h"
+#include "boid/FarField.h"
+#include "boid/GhostLayer.h"
+#include "boid/FlockStats.h"
+#include "boid/Determinism.h"
+#include "obstacle/Obstacle.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <optional>
+#include <thread>
+
+namespace
+{
+    namespace boid = simulation::boid;
+    using Clock = std::chrono::steady_clock;
+
+    // Longest the thread sleeps between checking for params, commands and stop(), even when the next step is further off
+    constexpr std::chrono::milliseconds maxSleep{ 2 };
+
+    simulation::TripleBuffer<simulation::SimParams> paramsBuffer{};
+    simulation::TripleBuffer<simulation::RenderSnapshot> snapshotBuffer{};
+    simulation::TripleBuffer<simulation::InputSnapshot> inputBuffer{};
+    simulation::SpscQueue<simulation::simthread::Command, 256> commands{};
+
+    std::thread thread{};
+    std::atomic<bool> running{ false };
+
+    // Only touched on the simulation thread
+    simulation::SimParams latestParams{};
+    std::optional<boid::flockstats::Stats> flockStats{};
+
+    void fillStats(simulation::SimulationStats& stats)
+    {
+        stats.stepsLastFrame = simulation::timestep::stepsLastFrame;
+        stats.droppedTime = simulation::timestep::droppedTime;
+        stats.lastStepMilliseconds = simulation::timestep::lastStepMilliseconds;
+        stats.stepTimings = boid::BoidObject::getStepTimings();
+
+        stats.arenaCapacity = simulation::frameArena.getCapacity();
+        stats.arenaHighWaterMark = simulation::frameArena.getHighWaterMark();
+        stats.arenaHeapAllocations = simulation::frameArena.getHeapAllocationsLastStep();
+        stats.bytesPerBoid = boid::BoidObject::s_boids.getBytesPerBoid();
+
+        stats.ghostCellsAvailable = boid::ghost::isAvailable();
+        stats.numGhosts = boid::ghost::numGhosts;
+        stats.ghostRebuildMilliseconds = boid::ghost::rebuildMilliseconds;
+        stats.ghostMemoryUsage = boid::ghost::getMemoryUsage();
+
+        stats.symmetricPassAvailable = boid::symmetric::isAvailable();
+
+        stats.mortonLocality = boid::morton::currentLocality;
+        stats.mortonLocalityAfterLastReorder = boid::morton::localityAfterLastReorder;
+
+        stats.farFieldError = boid::farfield::lastError;
+        stats.flockStats = flockStats;
+
+        stats.stateHash = boid::determinism::lastStateHash;
+        stats.hashedStep = boid::determinism::lastHashedStep;
+    }
+
+    void execute(const simulation::simthread::Command& command)
+    {
+        using Type = simulation::simthread::Command::Type;
+        switch (command.type)
+        {
+            case Type::spawnBoids :
+                boid::BoidObject::createBoid(latestParams, command.pos);
+                break;
+            case Type::placeObstacle :
+                simulation::obstacle::Obstacle::createObstacle(command.pos);
+                break;
+            case Type::makeBigCircleObstacle :
+                simulation::obstacle::makeBigCircleObstacle(latestParams.worldSize);
+                break;
+            case Type::clearBoids :
+                boid::BoidObject::s_boids.clear();
+                break;
+            case Type::clearObstacles :
+                simulation::obstacle::Obstacle::s_obstacles.clear();
+                break;
+            case Type::randomizeHues :
+                boid::globalVars::randomizeHues(latestParams);
+                break;
+            case Type::measureFlock :
+                flockStats = boid::flockstats::measure(latestParams);
+                break;
+            case Type::measureFarFieldError :
+                boid::farfield::errorMeasurementRequested = true;
+                break;
+        }
+    }
+
+    // now is the time the steps were run up to
+    void publishSnapshot(Clock::time_point now)
+    {
+        simulation::RenderSnapshot& snapshot{ snapshotBuffer.getWriteBuffer() };
+        const Clock::time_point fillStart{ Clock::now() };
+        boid::BoidObject::fillRenderSnapshot(latestParams, snapshot);
+        snapshot.stats.instanceFillMilliseconds = std::chrono::duration<float, std::milli>(Clock::now() - fillStart).count();
+
+        snapshot.obstacles.clear();
+        for (const simulation::obstacle::Obstacle& obstacle : simulation::obstacle::Obstacle::s_obstacles)
+            snapshot.obstacles.push_back(obstacle.getPos());
+
+        snapshot.interpolation = simulation::timestep::getInterpolationFactor(latestParams);
+        snapshot.stepSize = simulation::timestep::getStepSize(latestParams);
+        snapshot.publishTime = now;
+        fillStats(snapshot.stats);
+
+        snapshotBuffer.publish();
+    }
+
+    void run()
+    {
+        Clock::time_point lastTime{ Clock::now() };
+        while (running.load(std::memory_order_acquire))
+        {
+            bool changed{ false };
+            if (paramsBuffer.update())
+            {
+                latestParams = paramsBuffer.getReadBuffer();
+                changed = true;
+            }
+
+            // Nothing gets drawn from the input, so a new one alone isn't a change
+            if (inputBuffer.update())
+                simulation::input = inputBuffer.getReadBuffer();
+
+            simulation::simthread::Command command{};
+            while (commands.pop(command))
+            {
+                execute(command);
+                changed = true;
+            }
+
+            const Clock::time_point now{ Clock::now() };
+            const float frameTime{ std::chrono::duration<float>(now - lastTime).count() };
+            lastTime = now;
+
+            // A change with no step still has to show up (clearing the boids, a new color)
+            if (simulation::timestep::advance(latestParams, frameTime) > 0 || changed)
+                publishSnapshot(now);
+
+            const float untilNextStep{ (1.0f - simulation::timestep::getInterpolationFactor(latestParams)) * simulation::timestep::getStepSize(latestParams) };
+            std::this_thread::sleep_for(std::min<Clock::duration>(std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float>(untilNextStep)), maxSleep));
+        }
+    }
+}
+
+namespace simulation::simthread
+{
+    void start()
+    {
+        if (running.exchange(true))
+            return;
+
+        thread = std::thread{ run };
+    }
+
+    void stop()
+    {
+        if (!running.exchange(false))
+            return;
+
+        thread.join();
+    }
+
+    void publishParams(const SimParams& params)
+    {
+        paramsBuffer.getWriteBuffer() = params;
+        paramsBuffer.publish();
+    }
+
+    void publishInput(const InputSnapshot& input)
+    {
+        inputBuffer.getWriteBuffer() = input;
+        inputBuffer.publish();
+    }
+
+    bool post(Command command)
+    {
+        return commands.push(command);
+    }
+
+    const RenderSnapshot& acquireSnapshot()
+    {
+        snapshotBuffer.update();
+        return snapshotBuffer.getReadBuffer();
+    }
+
+    float getInterpolationFactor(const RenderSnapshot& snapshot)
+    {
+        // The snapshot was interpolation of the way to the next step when it got published, and the simulation has kept
+        // going since. Stopping at 1 means a late snapshot just holds the boids where they are instead of overshooting
+        const float elapsed{ std::chrono::duration<float>(Clock::now() - snapshot.publishTime).count() };
+        return std::min(snapshot.interpolation + elapsed / snapshot.stepSize, 1.0f);
+    }
+}
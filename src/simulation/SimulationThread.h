@@ -0,0 +1,54 @@
+#pragma once
+
+#include "SimParams.h"
+#include "InputSnapshot.h"
+#include "RenderSnapshot.h"
+
+#include <glm/glm.hpp>
+
+// Runs the fixed timestep loop on its own thread so a slow frame (vsync, a big ImGui window, the driver) can't hold the
+// simulation up and a slow step can't hold the frame up.
+//
+// Nothing crosses between the two threads except through here, and none of it takes a lock:
+// - The UI publishes a fresh SimParams and InputSnapshot every frame through triple buffers and the simulation thread
+//   picks up the newest ones before each round of steps. Missing a frame's worth of either doesn't matter since the
+//   next one replaces it anyway
+// - One-off things that mustn't get lost (spawning on a click, clearing, measuring) go through a queue of commands and
+//   run on the simulation thread between steps, in the order they were posted
+// - After each round of steps the simulation thread fills a RenderSnapshot and publishes it through another triple
+//   buffer, so the render loop always has the latest complete one to draw
+namespace simulation::simthread
+{
+    struct Command
+    {
+        enum class Type
+        {
+            spawnBoids,
+            placeObstacle,
+            makeBigCircleObstacle,
+            clearBoids,
+            clearObstacles,
+            randomizeHues,
+            measureFlock,
+            measureFarFieldError,
+        };
+
+        Type type{ Type::spawnBoids };
+        // Where to spawn the boids or place the obstacle
+        glm::vec2 pos{ 0.0f };
+    };
+
+    // Publish the starting params before this, the thread uses whatever it finds first
+    void start();
+    void stop();
+
+    // Render thread side
+    void publishParams(const SimParams& params);
+    void publishInput(const InputSnapshot& input);
+    // Runs command on the simulation thread before its next step. Returns false (and drops it) if too many are waiting already
+    bool post(Command command);
+    // Switches to the newest published snapshot if there is one. The reference stays valid until the next call
+    const RenderSnapshot& acquireSnapshot();
+    // How far between the snapshot's last two steps the boids should be drawn right now
+    float getInterpolationFactor(const RenderSnapshot& snapshot);
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+namespace simulation
+{
+    // Fixed size ring buffer for passing items from one producer thread to one consumer thread without locks. Each side
+    // only writes its own index, so a push or pop is a load of the other side's index and a store of its own
+    template<typename T, size_t Capacity>
+    class SpscQueue
+    {
+        static_assert((Capacity & (Capacity - 1)) == 0, "Capacity has to be a power of 2");
+
+        public:
+            // Producer side. Returns false (and drops item) if the queue is full
+            bool push(T item)
+            {
+                const size_t tail{ m_tail.load(std::memory_order_relaxed) };
+                if (tail - m_head.load(std::memory_order_acquire) == Capacity)
+                    return false;
+
+                m_items[tail & (Capacity - 1)] = std::move(item);
+                m_tail.store(tail + 1, std::memory_order_release);
+                return true;
+            }
+
+            // Consumer side. Returns false if the queue is empty
+            bool pop(T& item)
+            {
+                const size_t head{ m_head.load(std::memory_order_relaxed) };
+                if (head == m_tail.load(std::memory_order_acquire))
+                    return false;
+
+                item = std::move(m_items[head & (Capacity - 1)]);
+                m_head.store(head + 1, std::memory_order_release);
+                return true;
+            }
+
+        private:
+            std::array<T, Capacity> m_items{};
+            alignas(64) std::atomic<size_t> m_head{ 0 };
+            alignas(64) std::atomic<size_t> m_tail{ 0 };
+    };
+}
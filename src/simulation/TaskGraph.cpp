@@ -0,0 +1,153 @@
+#include "TaskGraph.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+namespace
+{
+    // Weight of the latest run in the moving average
+    constexpr float averageWeight{ 0.05f };
+}
+
+simulation::TaskGraph::NodeId simulation::TaskGraph::addTask(const char* name, Task task, std::initializer_list<NodeId> dependencies)
+{
+    Node& node{ m_nodes.emplace_back() };
+    node.task = std::move(task);
+    return addNode(name, node, dependencies);
+}
+
+simulation::TaskGraph::NodeId simulation::TaskGraph::addParallelTask(const char* name, size_t chunkSize, Count count, RangeTask task,
+                                                                     std::initializer_list<NodeId> dependencies)
+{
+    Node& node{ m_nodes.emplace_back() };
+    node.rangeTask = std::move(task);
+    node.count = std::move(count);
+    node.chunkSize = std::max(chunkSize, size_t{ 1 });
+    return addNode(name, node, dependencies);
+}
+
+simulation::TaskGraph::NodeId simulation::TaskGraph::addNode(const char* name, Node& node, std::initializer_list<NodeId> dependencies)
+{
+    const NodeId id{ m_nodes.size() - 1 };
+    for (const NodeId dependency : dependencies)
+        m_nodes[dependency].dependents.push_back(id);
+
+    node.numDependencies = static_cast<int>(dependencies.size());
+    m_timings.push_back({ name });
+    return id;
+}
+
+void simulation::TaskGraph::run()
+{
+    m_ready.clear();
+    for (NodeId id{ 0 }; id < m_nodes.size(); ++id)
+    {
+        m_nodes[id].remainingDependencies = m_nodes[id].numDependencies;
+        if (m_nodes[id].numDependencies == 0)
+            m_ready.push_back(id);
+    }
+
+    while (!m_ready.empty())
+    {
+        m_wave.swap(m_ready);
+        m_ready.clear();
+
+        // Work out how much each node has to do. The ones with nothing get skipped, but still count as done
+        m_active.clear();
+        for (const NodeId id : m_wave)
+        {
+            Node& node{ m_nodes[id] };
+            node.numItems = node.task ? 1 : node.count();
+            node.numChunks = node.task ? 1 : (node.numItems + node.chunkSize - 1) / node.chunkSize;
+
+            m_timings[id].ran = node.numItems > 0;
+            if (node.numItems > 0)
+                m_active.push_back(id);
+            else
+                m_timings[id].milliseconds = 0.0f;
+        }
+
+        if (m_active.size() == 1)
+            runAlone(m_active[0]);
+        else if (m_active.size() > 1)
+            runShared();
+
+        for (const NodeId id : m_active)
+            recordTiming(id);
+
+        for (const NodeId id : m_wave)
+        {
+            for (const NodeId dependent : m_nodes[id].dependents)
+            {
+                if (--m_nodes[dependent].remainingDependencies == 0)
+                    m_ready.push_back(dependent);
+            }
+        }
+    }
+}
+
+void simulation::TaskGraph::runAlone(NodeId id)
+{
+    Node& node{ m_nodes[id] };
+    node.startTime = Clock::now();
+    if (node.task)
+        node.task();
+    else
+        threadPool.parallelFor(node.numItems, node.chunkSize, node.rangeTask);
+    node.endTime = Clock::now();
+}
+
+void simulation::TaskGraph::runShared()
+{
+    m_items.clear();
+    for (const NodeId id : m_active)
+    {
+        if (m_nodes[id].task)
+            m_items.push_back({ id, 0 });
+    }
+
+    for (const NodeId id : m_active)
+    {
+        Node& node{ m_nodes[id] };
+        node.remainingChunks.store(node.numChunks, std::memory_order_relaxed);
+        node.started.store(false, std::memory_order_relaxed);
+        if (node.task)
+            continue;
+
+        for (size_t chunk{ 0 }; chunk < node.numChunks; ++chunk)
+            m_items.push_back({ id, chunk });
+    }
+
+    threadPool.parallelFor(m_items.size(), 1, [this](size_t begin, size_t end)
+    {
+        for (size_t i{ begin }; i < end; ++i)
+            runItem(m_items[i]);
+    });
+}
+
+void simulation::TaskGraph::runItem(const WorkItem& item)
+{
+    Node& node{ m_nodes[item.node] };
+    if (!node.started.exchange(true, std::memory_order_acq_rel))
+        node.startTime = Clock::now();
+
+    if (node.task)
+        node.task();
+    else
+    {
+        const size_t begin{ item.chunk * node.chunkSize };
+        node.rangeTask(begin, std::min(node.numItems, begin + node.chunkSize));
+    }
+
+    if (node.remainingChunks.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        node.endTime = Clock::now();
+}
+
+void simulation::TaskGraph::recordTiming(NodeId id)
+{
+    const Node& node{ m_nodes[id] };
+    Timing& timing{ m_timings[id] };
+    timing.milliseconds = std::chrono::duration<float, std::milli>(node.endTime - node.startTime).count();
+    timing.averageMilliseconds = timing.averageMilliseconds == 0.0f ? timing.milliseconds
+                                                                     : timing.averageMilliseconds + (timing.milliseconds - timing.averageMilliseconds) * averageWeight;
+}
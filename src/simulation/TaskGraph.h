@@ -0,0 +1,101 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <initializer_list>
+#include <vector>
+
+namespace simulation
+{
+    // A fixed set of named nodes with dependencies between them, run in dependency order on the shared thread pool and
+    // timed one by one.
+    //
+    // A node is either a task (one call, which can still use threadPool.parallelFor inside) or a parallel task (split into
+    // chunks like parallelFor). Each run goes in waves: every node whose dependencies are done goes into the next wave. If
+    // only one node in a wave has work, it runs the usual way and gets the whole pool. Otherwise all their tasks and chunks
+    // go to the pool as one job so they overlap, and a parallelFor inside one of the tasks runs inline on its thread (see
+    // ThreadPool::parallelFor). The tasks go first, so a long single threaded one doesn't get started last.
+    //
+    // The graph doesn't know what the nodes touch, so nodes that can end up in the same wave must not write anything the
+    // other reads. The frame arena isn't thread safe either, so at most one of them may allocate from it
+    class TaskGraph
+    {
+        public:
+            using NodeId = size_t;
+            using Task = std::function<void()>;
+            using RangeTask = std::function<void(size_t begin, size_t end)>;
+            using Count = std::function<size_t()>;
+
+            struct Timing
+            {
+                const char* name{ "" };
+                // From when the node's first chunk started to when its last one finished, in the latest run
+                float milliseconds{ 0.0f };
+                // Exponential moving average over the runs it did any work in
+                float averageMilliseconds{ 0.0f };
+                // False if it had nothing to do in the latest run
+                bool ran{ false };
+            };
+
+            // name has to outlive the graph (a string literal, in practice). Dependencies have to be added before the node
+            NodeId addTask(const char* name, Task task, std::initializer_list<NodeId> dependencies = {});
+            // count gets called at the start of the node's wave, and a node with nothing to do gets skipped
+            NodeId addParallelTask(const char* name, size_t chunkSize, Count count, RangeTask task, std::initializer_list<NodeId> dependencies = {});
+
+            bool empty() const { return m_nodes.empty(); }
+
+            // Runs every node once. Must not be called from inside a pool job
+            void run();
+
+            // In the order the nodes were added
+            const std::vector<Timing>& getTimings() const { return m_timings; }
+
+        private:
+            using Clock = std::chrono::steady_clock;
+
+            struct Node
+            {
+                Task task{};
+                RangeTask rangeTask{};
+                Count count{};
+                size_t chunkSize{ 0 };
+                std::vector<NodeId> dependents{};
+                int numDependencies{ 0 };
+
+                // Per run
+                int remainingDependencies{ 0 };
+                size_t numItems{ 0 };
+                size_t numChunks{ 0 };
+                std::atomic<size_t> remainingChunks{ 0 };
+                std::atomic<bool> started{ false };
+                Clock::time_point startTime{};
+                Clock::time_point endTime{};
+            };
+
+            // One chunk of a node in a shared wave (the whole node for a task)
+            struct WorkItem
+            {
+                NodeId node{ 0 };
+                size_t chunk{ 0 };
+            };
+
+            // A deque so the nodes (with their atomics) never get moved
+            std::deque<Node> m_nodes{};
+            std::vector<Timing> m_timings{};
+
+            // Scratch, kept around so running doesn't allocate once it's warmed up
+            std::vector<NodeId> m_wave{};
+            std::vector<NodeId> m_active{};
+            std::vector<NodeId> m_ready{};
+            std::vector<WorkItem> m_items{};
+
+            NodeId addNode(const char* name, Node& node, std::initializer_list<NodeId> dependencies);
+            void runAlone(NodeId id);
+            void runShared();
+            void runItem(const WorkItem& item);
+            void recordTiming(NodeId id);
+    };
+}
@@ -0,0 +1,194 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+
+namespace
+{
+    // How long a worker spins waiting for the next job before it goes to sleep. This is in the tens to low hundreds of
+    // microseconds, which covers the gaps between the parallel loops within one frame but not the gap between frames
+    constexpr int workerSpinCount{ 4096 };
+
+    // How long the calling thread spins waiting for the workers to finish before it starts yielding its time slice
+    constexpr int joinSpinCount{ 1024 };
+
+    void cpuRelax()
+    {
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64)
+        _mm_pause();
+#else
+        std::this_thread::yield();
+#endif
+    }
+
+    // Whether this thread is currently working on a job's chunks
+    thread_local bool insideJob{ false };
+
+    uint64_t packRange(uint32_t begin, uint32_t end) { return (static_cast<uint64_t>(end) << 32) | begin; }
+    uint32_t rangeBegin(uint64_t range) { return static_cast<uint32_t>(range); }
+    uint32_t rangeEnd(uint64_t range) { return static_cast<uint32_t>(range >> 32); }
+}
+
+namespace simulation
+{
+    ThreadPool threadPool{};
+}
+
+simulation::ThreadPool::ThreadPool(unsigned int numThreads)
+{
+    startWorkers(numThreads);
+}
+
+simulation::ThreadPool::~ThreadPool()
+{
+    stopWorkers();
+}
+
+void simulation::ThreadPool::resize(unsigned int numThreads)
+{
+    if (std::max(numThreads, 1u) == getNumThreads())
+        return;
+
+    stopWorkers();
+    startWorkers(numThreads);
+}
+
+bool simulation::ThreadPool::isInsideJob()
+{
+    return insideJob;
+}
+
+void simulation::ThreadPool::run(size_t count, size_t chunkSize, const void* context, Invoker invoker)
+{
+    m_context = context;
+    m_invoker = invoker;
+    m_count = count;
+    m_chunkSize = chunkSize;
+
+    // Hand every worker (including this thread as worker 0) an even share of the chunks to start with
+    const unsigned int numThreads{ getNumThreads() };
+    const uint64_t numChunks{ (count + chunkSize - 1) / chunkSize };
+    for (unsigned int worker{ 0 }; worker < numThreads; ++worker)
+    {
+        const uint32_t begin{ static_cast<uint32_t>(numChunks * worker / numThreads) };
+        const uint32_t end{ static_cast<uint32_t>(numChunks * (worker + 1) / numThreads) };
+        m_ranges[worker].range.store(packRange(begin, end), std::memory_order_relaxed);
+    }
+
+    m_numFinished.store(0, std::memory_order_relaxed);
+    m_epoch.fetch_add(1, std::memory_order_release);
+    m_epoch.notify_all();
+
+    insideJob = true;
+    work(0);
+    insideJob = false;
+
+    for (int spin{ 0 }; m_numFinished.load(std::memory_order_acquire) != numThreads - 1; ++spin)
+    {
+        if (spin < joinSpinCount)
+            cpuRelax();
+        else
+            std::this_thread::yield();
+    }
+}
+
+void simulation::ThreadPool::workerLoop(unsigned int workerIndex, uint64_t lastEpoch)
+{
+    while (true)
+    {
+        for (int spin{ 0 }; spin < workerSpinCount && m_epoch.load(std::memory_order_acquire) == lastEpoch; ++spin)
+            cpuRelax();
+
+        m_epoch.wait(lastEpoch, std::memory_order_acquire);
+        lastEpoch = m_epoch.load(std::memory_order_acquire);
+
+        if (m_stopping.load(std::memory_order_acquire))
+            return;
+
+        insideJob = true;
+        work(workerIndex);
+        insideJob = false;
+        m_numFinished.fetch_add(1, std::memory_order_release);
+    }
+}
+
+void simulation::ThreadPool::work(unsigned int workerIndex)
+{
+    do
+    {
+        uint32_t chunk;
+        while (popChunk(workerIndex, chunk))
+        {
+            const size_t begin{ chunk * m_chunkSize };
+            m_invoker(m_context, begin, std::min(m_count, begin + m_chunkSize));
+        }
+    }
+    while (stealChunks(workerIndex));
+}
+
+bool simulation::ThreadPool::popChunk(unsigned int workerIndex, uint32_t& chunk)
+{
+    std::atomic<uint64_t>& range{ m_ranges[workerIndex].range };
+    uint64_t current{ range.load(std::memory_order_acquire) };
+    while (rangeBegin(current) < rangeEnd(current))
+    {
+        if (range.compare_exchange_weak(current, packRange(rangeBegin(current) + 1, rangeEnd(current)), std::memory_order_acq_rel))
+        {
+            chunk = rangeBegin(current);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool simulation::ThreadPool::stealChunks(unsigned int workerIndex)
+{
+    const unsigned int numThreads{ getNumThreads() };
+    for (unsigned int offset{ 1 }; offset < numThreads; ++offset)
+    {
+        std::atomic<uint64_t>& victimRange{ m_ranges[(workerIndex + offset) % numThreads].range };
+        uint64_t current{ victimRange.load(std::memory_order_acquire) };
+        while (rangeBegin(current) < rangeEnd(current))
+        {
+            // Take the back half (rounded up, so a single remaining chunk can still be stolen)
+            const uint32_t middle{ rangeBegin(current) + (rangeEnd(current) - rangeBegin(current)) / 2 };
+            if (victimRange.compare_exchange_weak(current, packRange(rangeBegin(current), middle), std::memory_order_acq_rel))
+            {
+                m_ranges[workerIndex].range.store(packRange(middle, rangeEnd(current)), std::memory_order_release);
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+void simulation::ThreadPool::startWorkers(unsigned int numThreads)
+{
+    numThreads = std::max(numThreads, 1u);
+    m_ranges = std::make_unique<WorkerRange[]>(numThreads);
+
+    m_workers.reserve(numThreads - 1);
+    for (unsigned int worker{ 1 }; worker < numThreads; ++worker)
+        m_workers.emplace_back(&ThreadPool::workerLoop, this, worker, m_epoch.load(std::memory_order_relaxed));
+}
+
+void simulation::ThreadPool::stopWorkers()
+{
+    if (m_workers.empty())
+        return;
+
+    m_stopping.store(true, std::memory_order_release);
+    m_epoch.fetch_add(1, std::memory_order_release);
+    m_epoch.notify_all();
+
+    for (std::thread& worker : m_workers)
+        worker.join();
+
+    m_workers.clear();
+    m_stopping.store(false, std::memory_order_relaxed);
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace simulation
+{
+    // Persistent pool for the simulation's parallel loops. The thread calling parallelFor works as worker 0, so a pool
+    // with n threads starts n - 1 of its own.
+    //
+    // Each worker starts with an even share of the chunks and takes them from the front of its own range. A worker that
+    // runs out steals the back half of another worker's range, so dense parts of the flock don't leave threads idle.
+    // Between jobs the workers spin for a little while before going to sleep, which keeps fork/join down to a few
+    // microseconds when parallelFor gets called back to back within a frame
+    class ThreadPool
+    {
+        public:
+            explicit ThreadPool(unsigned int numThreads = 1);
+            ~ThreadPool();
+
+            ThreadPool(const ThreadPool&) = delete;
+            ThreadPool& operator=(const ThreadPool&) = delete;
+
+            // Must not be called while a parallelFor is running
+            void resize(unsigned int numThreads);
+            unsigned int getNumThreads() const { return static_cast<unsigned int>(m_workers.size()) + 1; }
+
+            // Calls func(begin, end) on chunks of at most chunkSize covering [0, count) and returns when they're all done.
+            // func gets called from several threads at once, so whatever it writes must not overlap between chunks.
+            //
+            // Called from inside another parallelFor's func (a TaskGraph node sharing the pool with others, say), it just
+            // runs the whole range on the calling thread since the other threads are already busy with the outer job
+            template<typename Func>
+            void parallelFor(size_t count, size_t chunkSize, const Func& func)
+            {
+                if (count == 0)
+                    return;
+
+                if (getNumThreads() == 1 || count <= chunkSize || isInsideJob())
+                {
+                    func(size_t{ 0 }, count);
+                    return;
+                }
+
+                run(count, chunkSize, &func, [](const void* context, size_t begin, size_t end)
+                {
+                    (*static_cast<const Func*>(context))(begin, end);
+                });
+            }
+
+        private:
+            using Invoker = void (*)(const void* context, size_t begin, size_t end);
+
+            // Range of chunk indices [begin, end) packed into one atomic so stealing can be done with a single CAS
+            struct alignas(64) WorkerRange
+            {
+                std::atomic<uint64_t> range{ 0 };
+            };
+
+            std::vector<std::thread> m_workers{};
+            std::unique_ptr<WorkerRange[]> m_ranges{};
+
+            std::atomic<uint64_t> m_epoch{ 0 };
+            std::atomic<unsigned int> m_numFinished{ 0 };
+            std::atomic<bool> m_stopping{ false };
+
+            // The current job. Only written by the calling thread while the workers are idle
+            const void* m_context{ nullptr };
+            Invoker m_invoker{ nullptr };
+            size_t m_count{ 0 };
+            size_t m_chunkSize{ 0 };
+
+            static bool isInsideJob();
+            void run(size_t count, size_t chunkSize, const void* context, Invoker invoker);
+            void workerLoop(unsigned int workerIndex, uint64_t lastEpoch);
+            void work(unsigned int workerIndex);
+            bool popChunk(unsigned int workerIndex, uint32_t& chunk);
+            bool stealChunks(unsigned int workerIndex);
+            void startWorkers(unsigned int numThreads);
+            void stopWorkers();
+    };
+
+    extern ThreadPool threadPool;
+}
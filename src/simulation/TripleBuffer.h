@@ -0,0 +1,55 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace simulation
+{
+    // Hands the latest version of a T from one producer thread to one consumer thread without either of them ever
+    // waiting. There are three copies: the producer fills one, the consumer reads another, and the third is the most
+    // recently published one. publish() swaps the producer's copy with the middle one and update() swaps the middle one
+    // with the consumer's, so the consumer always gets the newest complete T and anything the producer published in
+    // between is just skipped.
+    //
+    // The copies get reused, so a T that holds vectors stops allocating once they've grown to size. After publish() the
+    // producer gets back whatever copy the consumer last let go of, not the one it just filled
+    template<typename T>
+    class TripleBuffer
+    {
+        public:
+            // Producer side
+            T& getWriteBuffer() { return m_buffers[m_writeIndex]; }
+
+            void publish()
+            {
+                const uint8_t previous{ m_middle.exchange(static_cast<uint8_t>(m_writeIndex | freshBit), std::memory_order_acq_rel) };
+                m_writeIndex = previous & indexMask;
+            }
+
+            // Consumer side. Switches to the newest published copy and returns whether there was one
+            bool update()
+            {
+                if ((m_middle.load(std::memory_order_relaxed) & freshBit) == 0)
+                    return false;
+
+                const uint8_t previous{ m_middle.exchange(m_readIndex, std::memory_order_acq_rel) };
+                m_readIndex = previous & indexMask;
+                return true;
+            }
+
+            const T& getReadBuffer() const { return m_buffers[m_readIndex]; }
+
+        private:
+            // The middle index has a flag for whether the producer put it there (rather than the consumer)
+            static constexpr uint8_t indexMask{ 3 };
+            static constexpr uint8_t freshBit{ 4 };
+
+            std::array<T, 3> m_buffers{};
+
+            // Each index is only touched by one side, so they get their own cache lines
+            alignas(64) uint8_t m_writeIndex{ 0 };
+            alignas(64) std::atomic<uint8_t> m_middle{ 1 };
+            alignas(64) uint8_t m_readIndex{ 2 };
+    };
+}
@@ -1,343 +1,574 @@
 #include "BoidObject.h"
-#include "BoidParams.h"
-#include "../../Camera.h"
-#include "../../ShaderHandler.h"
-#include "../UI.h"
+#include "SpatialGrid.h"
+#include "MortonOrder.h"
+#include "FlockKernel.h"
+#include "SymmetricPass.h"
+#include "FarField.h"
+#include "GhostLayer.h"
+#include "Determinism.h"
+#include "../ThreadPool.h"
+#include "../Random.h"
+#include "../FastMath.h"
+#include "../FrameArena.h"
+#include "../SimParams.h"
+#include "../InputSnapshot.h"
 #include "../obstacle/Obstacle.h"
 
-#include <glm/gtc/type_ptr.hpp>
-
-#include <random>
 #include <array>
+#include <algorithm>
 #include <iostream>
+#include <utility>
 
 namespace
 {
-    glm::vec3 getRGBFromHue(float hue)
-    {
-        const float h{ hue * 6.0f };
-        const int i{ int(floor(h)) };
-        const float f{ h - i };
-        const float p{ simulation::boid::globalVars::brightness * (1.0f - simulation::boid::globalVars::saturation) };
-        const float q{ simulation::boid::globalVars::brightness * (1.0f - simulation::boid::globalVars::saturation * f) };
-        const float t{ simulation::boid::globalVars::brightness * (1.0f - simulation::boid::globalVars::saturation * (1.0f - f)) };
+    namespace boid = simulation::boid;
+    namespace fastmath = simulation::fastmath;
 
-        switch (i % 6)
-        {
-            case 0 : return { simulation::boid::globalVars::brightness, t, q };
-            case 1 : return { q, simulation::boid::globalVars::brightness, p };
-            case 2 : return { p, simulation::boid::globalVars::brightness, t };
-            case 3 : return { p, q, simulation::boid::globalVars::brightness };
-            case 4 : return { t, p, simulation::boid::globalVars::brightness };
-            case 5 : return { simulation::boid::globalVars::brightness, p, q };
-        }
+    // Small enough that work stealing can even out dense and sparse parts of the flock
+    constexpr size_t boidsPerChunk{ 256 };
 
-        return { 0.0f, 0.0f, 0.0f };
-    }
-}
+    // Which step we're on. It keys the per-step noise, and a boid recomputes its flocking steering when
+    // (id + stepCount) % params.flockUpdateInterval is 0. Ids are handed out in order, so any interval splits the flock evenly
+    uint64_t stepCount{ 0 };
+
+    // Optional parts of the per-boid update. updateBoidRange and applyExternalForces get compiled once for every
+    // combination of the ones they use, so the ones that are off don't cost a branch per boid (or any work at all). The
+    // vision cone test gets the same treatment inside the kernels (see FlockKernel.cpp), since that's where the per-pair loop is
+    namespace features
+    {
+        constexpr unsigned int blendHues{ 1 << 0 };
+        constexpr unsigned int hueNoise{ 1 << 1 };
+        constexpr unsigned int avoidMouse{ 1 << 2 };
+        constexpr unsigned int obstacles{ 1 << 3 };
 
-std::vector<simulation::boid::BoidObject> simulation::boid::BoidObject::s_boids{};
+        constexpr unsigned int numCombinations{ 1 << 4 };
 
-void simulation::boid::BoidObject::updateBoids(float deltaTime)
-{
-    std::vector<glm::vec2> updatedVelocities(s_boids.size());
+        // Which ones each pass cares about
+        constexpr unsigned int flocking{ blendHues | hueNoise };
+        constexpr unsigned int avoidance{ avoidMouse | obstacles };
+    }
 
-    // First, we filter out the neighboring boids that aren't actually neighbors (must be within radius and vision angle/cone)
-    for (size_t i{ 0 }; i < s_boids.size(); ++i)
+    // Everything the step's nodes need that stays the same for the whole step. The input node fills it in and the
+    // rest only read it (apart from writing their own boids' entries in the arrays)
+    struct StepContext
     {
-        BoidObject& primaryBoid{ s_boids[i] };
-        int numVisibleBoids{ 0 };
-        glm::vec2 updatedVelocity{ primaryBoid.m_velocity };
+        simulation::SimParams params{};
+        float deltaTime{ 0.0f };
+        glm::vec2 cursorPos{ 0.0f };
+        uint64_t step{ 0 };
+        // What this step's noise gets drawn with (see getSeed)
+        uint64_t seed{ 0 };
+        uint64_t flockUpdateInterval{ 1 };
+        size_t numBoids{ 0 };
+        unsigned int activeFeatures{ 0 };
+
+        bool useFarField{ false };
+        bool useSymmetricPass{ false };
+        bool useGhostLayer{ false };
+        bool deterministic{ false };
+
+        float* steeringNoiseX{ nullptr };
+        float* steeringNoiseY{ nullptr };
+        float* hueNoise{ nullptr };
+        // The noise plus obstacle and mouse avoidance, which don't depend on the other boids
+        glm::vec2* externalForces{ nullptr };
+        glm::vec2* updatedVelocities{ nullptr };
+    };
+
+    StepContext stepContext{};
+
+    // See buildStepGraph
+    simulation::TaskGraph stepGraph{};
+
+    boid::kernel::NeighborSums sumNeighbors(const StepContext& context, size_t i, glm::vec2 pos, glm::vec2 velocity)
+    {
+        if (context.useFarField)
+            return boid::farfield::sumNeighbors(context.params, pos, velocity);
 
-        glm::vec2 steeringForce{ 0.0f };
-        glm::vec2 noise{ globalVars::rd::centeredDistribution(globalVars::rd::randomNumberGenerator) * (globalVars::maxSpeed * 3.0f), globalVars::rd::centeredDistribution(globalVars::rd::randomNumberGenerator) * (globalVars::maxSpeed * 3.0f) };
-        steeringForce += noise;
+        if (context.useSymmetricPass)
+            return boid::symmetric::getSums(i);
 
-        glm::vec2 separationForce{ 0.0f };
-        glm::vec2 alignmentForce{ 0.0f };
-        glm::vec2 cohesionForce{ 0.0f };
+        // Only boids in the 3x3 block of cells around this one can be within the vision radius, and cells that are completely
+        // outside of the vision cone can be skipped too
+        const boid::grid::NeighborCells cells{ context.params.cullNeighborCells ? boid::grid::getVisibleNeighborCells(context.params, pos, velocity) : boid::grid::getNeighborCells(pos) };
+        if (context.deterministic)
+            return context.params.topologicalNeighbors ? boid::kernel::sumNearestNeighborsDeterministic(context.params, pos, velocity, cells, context.params.topologicalNeighborCount) : boid::kernel::sumNeighborsDeterministic(context.params, pos, velocity, cells);
 
-        float hueSinSum{ 0.0f };
-        float hueCosSum{ 0.0f };
+        if (context.useGhostLayer)
+            return context.params.topologicalNeighbors ? boid::ghost::sumNearestNeighbors(context.params, pos, velocity, cells, context.params.topologicalNeighborCount) : boid::ghost::sumNeighbors(context.params, pos, velocity, cells);
 
-        for (size_t j{ 0 }; j < s_boids.size(); ++j)
-        {
-            if (i == j) continue;
-            const BoidObject& otherBoid{ s_boids[j] };
+        return context.params.topologicalNeighbors ? boid::kernel::sumNearestNeighbors(context.params, pos, velocity, cells, context.params.topologicalNeighborCount) : boid::kernel::sumNeighbors(context.params, pos, velocity, cells);
+    }
 
-            glm::vec2 vecToOther{ otherBoid.m_pos - primaryBoid.m_pos };
+    // Direction to steer a boid away from something, blending straight away from it with going around it on the side the
+    // boid is already heading towards
+    glm::vec2 getAvoidDir(fastmath::Precision precision, glm::vec2 dirToBoid, glm::vec2 velocity, float tangentWeight, float awayWeight)
+    {
+        const glm::vec2 heading{ fastmath::normalize(precision, velocity) };
+        const float side{ heading.x * dirToBoid.y - heading.y * dirToBoid.x };
 
-            // Account for wraparound
-            if (std::abs(vecToOther.x) > Camera::screenWidth / 2.0f)
-                vecToOther.x -= glm::sign(vecToOther.x) * Camera::screenWidth;
-            if (std::abs(vecToOther.y) > Camera::screenHeight / 2.0f)
-                vecToOther.y -= glm::sign(vecToOther.y) * Camera::screenHeight;
+        glm::vec2 tangentDir;
+        if (side < 0.0f)
+            tangentDir = glm::vec2{ -dirToBoid.y, dirToBoid.x };
+        else
+            tangentDir = glm::vec2{ dirToBoid.y, -dirToBoid.x };
 
-            const float distance{ glm::length(vecToOther) };
-            if (distance > globalVars::visionRadius || distance < 1e-6) continue;
+        return fastmath::normalize(precision, tangentDir * tangentWeight + dirToBoid * awayWeight);
+    }
 
-            const glm::vec2 dirToOther{ glm::normalize(vecToOther) };
-            if (glm::dot(glm::normalize(primaryBoid.m_velocity), dirToOther) < globalVars::visionAngleCos) continue;
-            ++numVisibleBoids;
+    // Draws this step's noise and adds up the forces that don't depend on the other boids. Each boid only writes its own
+    // entries, and nothing here reads what the grid build writes, so this can run alongside it
+    template<unsigned int Features>
+    void applyExternalForces(const StepContext& context, size_t begin, size_t end)
+    {
+        const boid::BoidStore& boids{ boid::BoidObject::s_boids };
+        const float deltaTime{ context.deltaTime };
 
-            const float strength{ glm::clamp((globalVars::visionRadius - distance) / globalVars::visionRadius, 0.0f, 1.0f) };
-            separationForce += -dirToOther * strength;
+        // The noise is keyed on each boid's id and the step, so it doesn't matter how the boids got split into chunks
+        simulation::random::fillCentered(context.seed, simulation::random::Stream::stepNoise, context.step, boids.id() + begin, end - begin,
+            { context.steeringNoiseX + begin, context.steeringNoiseY + begin, context.hueNoise ? context.hueNoise + begin : nullptr, nullptr });
 
-            //alignmentForce += otherBoid.m_velocity * strength;
-            alignmentForce += glm::normalize(otherBoid.m_velocity) * strength;
+        for (size_t i{ begin }; i < end; ++i)
+        {
+            glm::vec2 steeringForce{ 0.0f };
+            steeringForce += glm::vec2{ context.steeringNoiseX[i], context.steeringNoiseY[i] } * (context.params.maxSpeed * 3.0f);
 
-            cohesionForce += primaryBoid.m_pos + vecToOther; // I'm doing this instead of using neighborBoid.m_pos to account for wraparound
+            // Obstacle avoidance
+            if constexpr ((Features & (features::obstacles | features::avoidMouse)) != 0)
+            {
+                const glm::vec2 pos{ boids.getPos(i) };
+                const glm::vec2 velocity{ boids.getVelocity(i) };
+                glm::vec2 avoidObstacleForce{ 0.0f };
+                const glm::vec2 lookAheadPos{ pos + velocity * deltaTime };
+
+                if constexpr ((Features & features::obstacles) != 0)
+                {
+                    for (const simulation::obstacle::Obstacle& obstacle : simulation::obstacle::Obstacle::s_obstacles)
+                    {
+                        const glm::vec2 vecToBoid{ lookAheadPos - obstacle.getPos() };
+                        const float distance{ fastmath::length(context.params.precision, vecToBoid) };
+
+                        if (distance <= 0 || distance >= context.params.obstacleRadius * 12.5f)
+                            continue;
+
+                        const glm::vec2 dirToBoid{ fastmath::normalize(context.params.precision, vecToBoid) };
+                        const float falloff{ glm::smoothstep(context.params.obstacleRadius * 12.5f, context.params.obstacleRadius, distance) };
+
+                        // This is here so that if the boid is about to directly hit a wall of obstacles, it won't rely on tengential forces to avoid it
+                        // because those tangential forces would average out to 0 to make it just pass through the wall
+                        if (falloff > 0.965f)
+                        {
+                            avoidObstacleForce += dirToBoid * falloff * 12.0f;
+                            continue;
+                        }
+
+                        avoidObstacleForce += getAvoidDir(context.params.precision, dirToBoid, velocity, 0.5f, 0.5f) * falloff;
+                    }
+                }
+
+                if constexpr ((Features & features::avoidMouse) != 0)
+                {
+                    const glm::vec2 vecToBoid{ lookAheadPos - context.cursorPos };
+                    const float distance{ fastmath::length(context.params.precision, vecToBoid) };
+
+                    if (distance > 0 || distance < context.params.obstacleRadius * 15.0f)
+                    {
+                        const glm::vec2 dirToBoid{ fastmath::normalize(context.params.precision, vecToBoid) };
+                        const float falloff{ glm::smoothstep(context.params.obstacleRadius * 15.0f, context.params.obstacleRadius, distance) };
+                        avoidObstacleForce += getAvoidDir(context.params.precision, dirToBoid, velocity, 0.2f, 0.8f) * falloff * context.params.avoidMouseScale;
+                    }
+                }
+
+                steeringForce += avoidObstacleForce * (context.params.worldSize.x * 0.625f);
+            }
 
-            // Hue averaging using complex number projection
-            const float hueAngle{ glm::two_pi<float>() * otherBoid.m_hue };
-            hueSinSum += sin(hueAngle);
-            hueCosSum += cos(hueAngle);
+            context.externalForces[i] = steeringForce;
         }
+    }
 
-        // Obstacle avoidance
-        glm::vec2 avoidObstacleForce{ 0.0f };
-        const glm::vec2 lookAheadPos{ primaryBoid.m_pos + primaryBoid.m_velocity * deltaTime };
-        for (const obstacle::Obstacle& obstacle : obstacle::Obstacle::s_obstacles)
+    // First, we filter out the neighboring boids that aren't actually neighbors (must be within radius and vision angle/cone).
+    // Each boid only writes its own updatedVelocities entry, its own hue and its own flocking cache, so the chunks can run on any thread
+    template<unsigned int Features>
+    void updateBoidRange(const StepContext& context, size_t begin, size_t end)
+    {
+        // Position, velocity and hue go through the accessors since they might be packed (see BoidStore::Storage)
+        boid::BoidStore& boids{ boid::BoidObject::s_boids };
+        float* const flockForceX{ boids.flockForceX() };
+        float* const flockForceY{ boids.flockForceY() };
+        float* const flockHue{ boids.flockHue() };
+        uint8_t* const hasFlockCache{ boids.hasFlockCache() };
+        const uint32_t* const ids{ boids.id() };
+        const float deltaTime{ context.deltaTime };
+
+        for (size_t i{ begin }; i < end; ++i)
         {
-            const glm::vec2 vecToBoid{ lookAheadPos - obstacle.getPos() };
-            const float distance{ glm::length(vecToBoid) };
+            const glm::vec2 pos{ boids.getPos(i) };
+            const glm::vec2 velocity{ boids.getVelocity(i) };
+            float hue{ boids.getHue(i) };
+            glm::vec2 updatedVelocity{ velocity };
 
-            if (distance <= 0 || distance >= obstacle::radius * 12.5f)
-                continue;
+            glm::vec2 steeringForce{ context.externalForces[i] };
 
-            const glm::vec2 dirToBoid{ glm::normalize(vecToBoid) };
-            const float falloff{ glm::smoothstep(obstacle::radius * 12.5f, obstacle::radius, distance) };
+            // Only 1 in flockUpdateInterval boids redo the neighbor search each step. The rest reuse the flocking steering
+            // and average hue they got last time (new boids don't have any yet, so they always go)
+            if (!hasFlockCache[i] || (ids[i] + context.step) % context.flockUpdateInterval == 0)
+            {
+                const boid::kernel::NeighborSums neighborSums{ sumNeighbors(context, i, pos, velocity) };
+                const int numVisibleBoids{ neighborSums.numVisible };
+
+                glm::vec2 flockForce{ 0.0f };
+                float avgHue{ -1.0f };
+                if (numVisibleBoids > 0)
+                {
+                    // *************
+                    // Update forces
+                    // *************
+
+                    // Separation
+                    const glm::vec2 separationForce{ neighborSums.separation * context.params.separation };
+
+                    // Alignment
+                    const glm::vec2 alignmentForce{ neighborSums.alignment * context.params.alignment };
+
+                    // Cohesion
+                    const glm::vec2 cohesionForce{ (neighborSums.cohesion / static_cast<float>(numVisibleBoids) - pos) * context.params.cohesion };
+
+                    flockForce = separationForce + alignmentForce + cohesionForce;
+
+                    // Without blending the average hue isn't used, so the boid's own hue is just a placeholder that's at least
+                    // harmless for the few steps it can stay cached after blending gets turned back on
+                    avgHue = hue;
+                    if constexpr ((Features & features::blendHues) != 0)
+                    {
+                        float avgHueAngle{ fastmath::atan2(context.params.precision, neighborSums.hueSin, neighborSums.hueCos) };
+                        if (avgHueAngle < 0.0f)
+                            avgHueAngle += glm::two_pi<float>();
+
+                        avgHue = avgHueAngle / glm::two_pi<float>();
+                    }
+                }
+
+                flockForceX[i] = flockForce.x;
+                flockForceY[i] = flockForce.y;
+                flockHue[i] = avgHue;
+                hasFlockCache[i] = 1;
+            }
 
-            // This is here so that if the boid is about to directly hit a wall of obstacles, it won't rely on tengential forces to avoid it
-            // because those tangential forces would average out to 0 to make it just pass through the wall
-            if (falloff > 0.965f)
+            if (flockHue[i] >= 0.0f)
             {
-                avoidObstacleForce += dirToBoid * falloff * 12.0f;
-                continue;
+                // Update positions and velocities
+                steeringForce += glm::vec2{ flockForceX[i], flockForceY[i] };
+
+                // **********
+                // Update hue
+                // **********
+                if constexpr ((Features & features::blendHues) != 0)
+                {
+                    float hueDelta{ flockHue[i] - hue };
+                    if (hueDelta > 0.5f) 
+                        hueDelta -= 1.0f;
+                    else if (hueDelta < -0.5f) 
+                        hueDelta += 1.0f;
+
+                    hue += hueDelta * 3.0f * deltaTime;
+
+                    if constexpr ((Features & features::hueNoise) != 0)
+                        hue += context.hueNoise[i] * deltaTime;
+
+                    hue = fastmath::wrap(context.params.precision, hue, 1.0f);
+                    boids.setHue(i, hue);
+                }
             }
 
-            const glm::vec2 heading{ glm::normalize(primaryBoid.m_velocity) };
-            const float side{ heading.x * dirToBoid.y - heading.y * dirToBoid.x };
+            updatedVelocity = velocity + steeringForce * deltaTime;
 
-            glm::vec2 tangentDir;
-            if (side < 0.0f)
-                tangentDir = glm::vec2{ -dirToBoid.y, dirToBoid.x };
-            else
-                tangentDir = glm::vec2{ dirToBoid.y, -dirToBoid.x };
+            if (fastmath::length(context.params.precision, updatedVelocity) > context.params.maxSpeed)
+                updatedVelocity = fastmath::normalize(context.params.precision, updatedVelocity) * context.params.maxSpeed;
 
-            const glm::vec2 blendedAvoidDir{ glm::normalize(tangentDir * 0.5f + dirToBoid * 0.5f) };
-            avoidObstacleForce += blendedAvoidDir * falloff;
+            context.updatedVelocities[i] = updatedVelocity;
         }
+    }
 
-        if (ui::avoidMouse)
-        {
-            double xCursorPos, yCursorPos;
-            glfwGetCursorPos(Camera::window, &xCursorPos, &yCursorPos);
-			xCursorPos *= simulation::ui::cursors::cursorScaleFactor;
-			yCursorPos *= simulation::ui::cursors::cursorScaleFactor;
-            const glm::vec2 vecToBoid{ lookAheadPos - glm::vec2{ static_cast<float>(xCursorPos), static_cast<float>(yCursorPos) } };
-            const float distance{ glm::length(vecToBoid) };
-
-            if (distance > 0 || distance < obstacle::radius * 15.0f)
-            {
-                const glm::vec2 dirToBoid{ glm::normalize(vecToBoid) };
-                const float falloff{ glm::smoothstep(obstacle::radius * 15.0f, obstacle::radius, distance) };
-
-                const glm::vec2 heading{ glm::normalize(primaryBoid.m_velocity) };
-                const float side{ heading.x * dirToBoid.y - heading.y * dirToBoid.x };
+    using BoidRangeFunc = void(*)(const StepContext&, size_t, size_t);
 
-                glm::vec2 tangentDir;
-                if (side < 0.0f)
-                    tangentDir = glm::vec2{ -dirToBoid.y, dirToBoid.x };
-                else
-                    tangentDir = glm::vec2{ dirToBoid.y, -dirToBoid.x };
+    template<size_t... FeatureSets>
+    constexpr std::array<BoidRangeFunc, sizeof...(FeatureSets)> makeUpdateTable(std::index_sequence<FeatureSets...>)
+    {
+        return { &updateBoidRange<FeatureSets & features::flocking>... };
+    }
 
-                const glm::vec2 blendedAvoidDir{ glm::normalize(tangentDir * 0.2f + dirToBoid * 0.8f) };
-                avoidObstacleForce += blendedAvoidDir * falloff * ui::avoidMouseScale;
-            }
-        }
+    template<size_t... FeatureSets>
+    constexpr std::array<BoidRangeFunc, sizeof...(FeatureSets)> makeExternalForcesTable(std::index_sequence<FeatureSets...>)
+    {
+        return { &applyExternalForces<FeatureSets & features::avoidance>... };
+    }
 
-        steeringForce += avoidObstacleForce * (Camera::screenWidth * 0.625f);
+    // Indexed by the features bitmask
+    constexpr std::array<BoidRangeFunc, features::numCombinations> updateTable{ makeUpdateTable(std::make_index_sequence<features::numCombinations>{}) };
+    constexpr std::array<BoidRangeFunc, features::numCombinations> externalForcesTable{ makeExternalForcesTable(std::make_index_sequence<features::numCombinations>{}) };
 
-        if (numVisibleBoids > 0)
-        {
-            // *************
-            // Update forces
-            // *************
+    unsigned int getActiveFeatures(const simulation::SimParams& params)
+    {
+        unsigned int active{ 0 };
+        if (params.blendHues)
+            active |= features::blendHues;
+        // The noise only gets added on top of the blending
+        if (params.blendHues && params.saturation < 0.7f)
+            active |= features::hueNoise;
+        if (params.avoidMouse)
+            active |= features::avoidMouse;
+        if (!simulation::obstacle::Obstacle::s_obstacles.empty())
+            active |= features::obstacles;
+
+        return active;
+    }
 
-            // Separation
-            separationForce *= globalVars::separation;
+    // Moves a boid that's gone margin past one side of the screen to the other side. Written with selects instead of
+    // branches so the integration loop doesn't have to guess which boids are about to wrap
+    float wrapCoordinate(float x, float screenSize, float margin)
+    {
+        const float period{ screenSize + margin };
+        x -= x - margin > screenSize ? period : 0.0f;
+        x += x + margin < 0.0f ? period : 0.0f;
+        return x;
+    }
 
-            // Alignment
-            alignmentForce *= globalVars::alignment;
+    // Takes everything the step needs from the params and the input snapshot and sets up its arrays. Everything only this
+    // step needs comes from the frame arena, which gets reset at the end
+    void snapshotInput()
+    {
+        StepContext& context{ stepContext };
+        const size_t numBoids{ boid::BoidObject::s_boids.size() };
+        context.numBoids = numBoids;
+        context.step = stepCount++;
+        context.flockUpdateInterval = static_cast<uint64_t>(std::max(context.params.flockUpdateInterval, 1));
+        context.activeFeatures = getActiveFeatures(context.params);
+
+        // GLFW can only be called from the main thread, so the cursor comes from the frame's input snapshot
+        context.cursorPos = simulation::input.cursorPos;
+
+        // Everything that sums neighbors in its own order gets skipped in deterministic mode (see Determinism.h)
+        context.deterministic = context.params.deterministic;
+        context.seed = simulation::getSeed(context.params);
+
+        context.steeringNoiseX = simulation::frameArena.allocate<float>(numBoids);
+        context.steeringNoiseY = simulation::frameArena.allocate<float>(numBoids);
+        context.hueNoise = (context.activeFeatures & features::hueNoise) != 0 ? simulation::frameArena.allocate<float>(numBoids) : nullptr;
+        context.externalForces = simulation::frameArena.allocate<glm::vec2>(numBoids);
+        context.updatedVelocities = simulation::frameArena.allocate<glm::vec2>(numBoids);
+    }
 
-            // Cohesion
-            cohesionForce /= numVisibleBoids;
-            cohesionForce = (cohesionForce - primaryBoid.m_pos) * globalVars::cohesion;
+    // Copies the boids into grid order for the kernels and builds whichever neighbor structure the settings pick
+    void buildNeighborData()
+    {
+        StepContext& context{ stepContext };
+        const bool deterministic{ context.deterministic };
 
-            // Update positions and velocities
-            steeringForce += separationForce + alignmentForce + cohesionForce;
+        // Aggregated nodes don't have individual boids to pick the nearest few out of
+        context.useFarField = !deterministic && context.params.farFieldAggregates && !context.params.topologicalNeighbors;
 
-            // **********
-            // Update hue
-            // **********
-            if (!ui::blendHues)
-                continue;
+        // The symmetric pass sums every visible pair, so it can't be used to pick out the nearest few either. It also always
+        // sums every boid, so there'd be nothing left for staggered updates to skip
+        const bool staggered{ context.params.flockUpdateInterval > 1 };
+        context.useSymmetricPass = !deterministic && !context.useFarField && !context.params.topologicalNeighbors && !staggered && context.params.symmetricPairs && boid::symmetric::isAvailable();
 
-            float avgHueAngle{ static_cast<float>(atan2(hueSinSum, hueCosSum)) };
-            if (avgHueAngle < 0.0f)
-                avgHueAngle += glm::two_pi<float>();
+        // Only the plain grid search reads the ghost cells. The ghost layer gathers the boids into its padded grid itself,
+        // so kernel::neighborData only gets filled in when it's off
+        context.useGhostLayer = !deterministic && !context.useFarField && !context.useSymmetricPass && context.params.ghostCells && boid::ghost::isAvailable();
+        if (context.useGhostLayer)
+        {
+            boid::ghost::rebuild(context.params);
+            return;
+        }
 
-            const float avgHue{ avgHueAngle / glm::two_pi<float>() };
+        boid::kernel::gatherNeighborData(context.params);
+        if (context.useFarField)
+            boid::farfield::update(context.params);
+        if (context.useSymmetricPass)
+            boid::symmetric::accumulate(context.params);
+    }
 
-            float hueDelta{ avgHue - primaryBoid.m_hue };
-            if (hueDelta > 0.5f) 
-                hueDelta -= 1.0f;
-            else if (hueDelta < -0.5f) 
-                hueDelta += 1.0f;
+    void integrateRange(const StepContext& context, size_t begin, size_t end)
+    {
+        boid::BoidStore& boids{ boid::BoidObject::s_boids };
+        const glm::vec2* const updatedVelocities{ context.updatedVelocities };
+        const float deltaTime{ context.deltaTime };
+        const glm::vec2 worldSize{ context.params.worldSize };
+        const float wrapMargin{ context.params.wrapMargin };
 
-            primaryBoid.m_hue += hueDelta * 3.0f * deltaTime;
+        if (boids.getStorage() == boid::BoidStore::Storage::full)
+        {
+            float* const posX{ boids.posX() };
+            float* const posY{ boids.posY() };
+            float* const velX{ boids.velX() };
+            float* const velY{ boids.velY() };
+            float* const prevPosX{ boids.prevPosX() };
+            float* const prevPosY{ boids.prevPosY() };
+
+            for (size_t i{ begin }; i < end; ++i)
+            {
+                velX[i] = updatedVelocities[i].x;
+                velY[i] = updatedVelocities[i].y;
 
-            if (globalVars::saturation < 0.7f)
+                prevPosX[i] = posX[i];
+                prevPosY[i] = posY[i];
+                posX[i] = wrapCoordinate(posX[i] + velX[i] * deltaTime, worldSize.x, wrapMargin);
+                posY[i] = wrapCoordinate(posY[i] + velY[i] * deltaTime, worldSize.y, wrapMargin);
+            }
+        }
+        else
+        {
+            for (size_t i{ begin }; i < end; ++i)
             {
-                const float hueNoise{ globalVars::rd::centeredDistribution(globalVars::rd::randomNumberGenerator) };
-                primaryBoid.m_hue += hueNoise * deltaTime;
+                const glm::vec2 pos{ boids.getPos(i) };
+                const glm::vec2 velocity{ updatedVelocities[i] };
+                boids.setVelocity(i, velocity);
+                boids.setPrevPos(i, pos);
+                boids.setPos(i, { wrapCoordinate(pos.x + velocity.x * deltaTime, worldSize.x, wrapMargin),
+                                  wrapCoordinate(pos.y + velocity.y * deltaTime, worldSize.y, wrapMargin) });
             }
-
-            primaryBoid.m_hue = std::fmod(primaryBoid.m_hue + 1.0f, 1.0f);
         }
+    }
 
-        updatedVelocity = primaryBoid.m_velocity + steeringForce * deltaTime;
-
-        if (glm::length(updatedVelocity) > globalVars::maxSpeed)
-            updatedVelocity = glm::normalize(updatedVelocity) * globalVars::maxSpeed;
+    // A step as a graph:
+    //
+    //   input -> reorder -> spatial build -> neighbor data -> boid forces -> integrate
+    //                    \-> obstacle forces -----------------/
+    //
+    // The grid's counting sort is single threaded, so the other threads draw the noise and work out the obstacle forces
+    // in the meantime. Everything else gets the whole pool. Reordering moves boids around in the store, so it has to be
+    // done before anything that indexes into it starts
+    void buildStepGraph()
+    {
+        using simulation::TaskGraph;
+        const auto getNumBoids{ [] { return stepContext.numBoids; } };
 
-        updatedVelocities[i] = updatedVelocity;
+        const TaskGraph::NodeId input{ stepGraph.addTask("Input snapshot", snapshotInput) };
+        const TaskGraph::NodeId reorder{ stepGraph.addTask("Reorder", [] { boid::morton::reorderIfNeeded(stepContext.params); }, { input }) };
+        const TaskGraph::NodeId spatialBuild{ stepGraph.addTask("Spatial build", [] { boid::grid::rebuild(stepContext.params); }, { reorder }) };
+        const TaskGraph::NodeId obstacleForces{ stepGraph.addParallelTask("Obstacle forces", boidsPerChunk, getNumBoids, [](size_t begin, size_t end)
+        {
+            externalForcesTable[stepContext.activeFeatures](stepContext, begin, end);
+        }, { reorder }) };
+        const TaskGraph::NodeId neighborData{ stepGraph.addTask("Neighbor data", buildNeighborData, { spatialBuild }) };
+        const TaskGraph::NodeId boidForces{ stepGraph.addParallelTask("Boid forces", boidsPerChunk, getNumBoids, [](size_t begin, size_t end)
+        {
+            updateTable[stepContext.activeFeatures](stepContext, begin, end);
+        }, { neighborData, obstacleForces }) };
+        stepGraph.addParallelTask("Integrate", boidsPerChunk, getNumBoids, [](size_t begin, size_t end)
+        {
+            integrateRange(stepContext, begin, end);
+        }, { boidForces });
     }
 
-    for (size_t i{ 0 }; i < s_boids.size(); ++i)
+    glm::vec3 getRGBFromHue(float hue, float saturation, float brightness)
     {
-        BoidObject& boid{ s_boids[i] };
-
-        boid.m_velocity = updatedVelocities[i];
-
-        boid.m_pos += boid.m_velocity * deltaTime;
-        if (boid.m_pos.y - globalVars::triangleHeight > Camera::screenHeight)
-            boid.m_pos.y -= Camera::screenHeight + globalVars::triangleHeight;
-        if (boid.m_pos.y + globalVars::triangleHeight < 0)
-            boid.m_pos.y += Camera::screenHeight + globalVars::triangleHeight;
-        if (boid.m_pos.x - globalVars::triangleHeight > Camera::screenWidth)
-            boid.m_pos.x -= Camera::screenWidth + globalVars::triangleHeight;
-        if (boid.m_pos.x + globalVars::triangleHeight < 0)
-            boid.m_pos.x += Camera::screenWidth + globalVars::triangleHeight;
+        const float h{ hue * 6.0f };
+        const int i{ int(floor(h)) };
+        const float f{ h - i };
+        const float p{ brightness * (1.0f - saturation) };
+        const float q{ brightness * (1.0f - saturation * f) };
+        const float t{ brightness * (1.0f - saturation * (1.0f - f)) };
+
+        switch (i % 6)
+        {
+            case 0 : return { brightness, t, q };
+            case 1 : return { q, brightness, p };
+            case 2 : return { p, brightness, t };
+            case 3 : return { p, q, brightness };
+            case 4 : return { t, p, brightness };
+            case 5 : return { brightness, p, q };
+        }
+
+        return { 0.0f, 0.0f, 0.0f };
     }
 }
 
-void simulation::boid::BoidObject::createBoid(glm::vec2 pos)
-{
-    glm::vec2 velocity{ glm::vec2{ 
-        globalVars::rd::centeredDistribution(globalVars::rd::randomNumberGenerator),
-        globalVars::rd::centeredDistribution(globalVars::rd::randomNumberGenerator) 
-    } * (globalVars::maxSpeed * 0.25f) };
+simulation::boid::BoidStore simulation::boid::BoidObject::s_boids{};
 
-    float hue{ (globalVars::rd::centeredDistribution(globalVars::rd::randomNumberGenerator) + 1.0f) / 2.0f };
+void simulation::boid::BoidObject::updateBoids(const SimParams& stepParams, float deltaTime)
+{
+    // Converting doesn't move any boids, but it does have to happen before anything reads them this step. A new screen size
+    // also needs the compact positions re-quantized
+    s_boids.setStorage(stepParams.compactBoidState ? BoidStore::Storage::compact : BoidStore::Storage::full, stepParams.worldSize);
+    threadPool.resize(stepParams.numThreads);
 
-    if (ui::numBoidsPerClick == 1)
-    {
-        s_boids.emplace_back(pos, velocity, hue);
-        return;
-    }
+    if (stepGraph.empty())
+        buildStepGraph();
 
-    for (int i{ 0 }; i < ui::numBoidsPerClick; ++i)
-    {
-        if (!ui::groupBoidsShareSameHue)
-            hue = (globalVars::rd::centeredDistribution(globalVars::rd::randomNumberGenerator) + 1.0f) / 2.0f;
+    // Every node reads the step's params from the context, and passes them on to the modules it calls
+    stepContext = StepContext{};
+    stepContext.params = stepParams;
+    stepContext.deltaTime = deltaTime;
+    stepGraph.run();
 
-        if (!ui::randomizeGroupBoidPositions)
-        {
-            velocity = glm::vec2{ 
-                globalVars::rd::centeredDistribution(globalVars::rd::randomNumberGenerator),
-                globalVars::rd::centeredDistribution(globalVars::rd::randomNumberGenerator) 
-            } * (globalVars::maxSpeed * 0.25f);
+    if (stepContext.deterministic)
+        determinism::recordStep(stepContext.step);
 
-            s_boids.emplace_back(pos, velocity, hue);
-            continue;
-        }
+    frameArena.reset();
+}
 
-        const glm::vec2 posNoise { 
-            glm::vec2
-            {
-                globalVars::rd::centeredDistribution(globalVars::rd::randomNumberGenerator),
-                globalVars::rd::centeredDistribution(globalVars::rd::randomNumberGenerator) 
-            } * Camera::screenWidth / 10.0f
-        };
-
-        if (!ui::groupBoidsPointInSameDir)
-            velocity = glm::vec2{ 
-                globalVars::rd::centeredDistribution(globalVars::rd::randomNumberGenerator),
-                globalVars::rd::centeredDistribution(globalVars::rd::randomNumberGenerator) 
-            } * (globalVars::maxSpeed * 0.25f);
-
-        s_boids.emplace_back(pos + posNoise, velocity, hue);
-    }
+const std::vector<simulation::TaskGraph::Timing>& simulation::boid::BoidObject::getStepTimings()
+{
+    return stepGraph.getTimings();
 }
 
-void simulation::boid::BoidObject::renderAllBoids()
+void simulation::boid::BoidObject::createBoid(const SimParams& params, glm::vec2 pos)
 {
-    // Remember that depth testing is off
-    // First, render the vision cones, then the outlines, then the boids themselves, and finally m_pos as points
-    if (ui::showVisionCones)
+    // Each new boid's random numbers are keyed on the id it's about to get. Draw 0 is its velocity and hue, draw 1 is where
+    // it goes in a randomized group. Whatever a group shares comes from the first boid's draws
+    const auto getVelocity{ [&params](const std::array<float, 4>& values) { return glm::vec2{ values[0], values[1] } * (params.maxSpeed * 0.25f); } };
+    const auto getHue{ [](const std::array<float, 4>& values) { return (values[2] + 1.0f) / 2.0f; } };
+
+    const uint64_t seed{ getSeed(params) };
+    const uint32_t firstId{ s_boids.getNextId() };
+    const std::array<float, 4> first{ random::drawCentered(seed, random::Stream::spawn, firstId, 0) };
+    const glm::vec2 groupVelocity{ getVelocity(first) };
+    const float groupHue{ getHue(first) };
+
+    if (params.numBoidsPerClick == 1)
     {
-        glBindVertexArray(ui::visionConeVAO);
+        s_boids.push(pos, groupVelocity, groupHue);
+        return;
+    }
 
-        glUniform3fv(glGetUniformLocation(ShaderHandler::shaderProgram, "color"), 1, glm::value_ptr(glm::vec3{ 0.1f, 0.1f, 0.1f }));
-        for (const BoidObject& boid : s_boids)
-        {
-            glm::mat4 model{ glm::translate(glm::mat4{ 1.0f }, glm::vec3{ boid.m_pos, 0.0f }) };
-            model = glm::rotate(model, boid.getRotation(), glm::vec3{ 0.0f, 0.0f, 1.0f });
-            glUniformMatrix4fv(glGetUniformLocation(ShaderHandler::shaderProgram, "mvp"), 1, GL_FALSE, glm::value_ptr(Camera::viewProjection * model));
-            glDrawArrays(GL_TRIANGLE_FAN, 0, ui::visionConeVertices.size());
-        }
+    for (int i{ 0 }; i < params.numBoidsPerClick; ++i)
+    {
+        const uint32_t id{ firstId + static_cast<uint32_t>(i) };
+        const std::array<float, 4> own{ random::drawCentered(seed, random::Stream::spawn, id, 0) };
+        const float hue{ params.groupBoidsShareSameHue ? groupHue : getHue(own) };
 
-        glUniform3fv(glGetUniformLocation(ShaderHandler::shaderProgram, "color"), 1, glm::value_ptr(glm::vec3{ 0.35f, 0.35f, 0.35f }));
-        for (const BoidObject& boid : s_boids)
+        if (!params.randomizeGroupBoidPositions)
         {
-            glm::mat4 model{ glm::translate(glm::mat4{ 1.0f }, glm::vec3{ boid.m_pos, 0.0f }) };
-            model = glm::rotate(model, boid.getRotation(), glm::vec3{ 0.0f, 0.0f, 1.0f });
-            glUniformMatrix4fv(glGetUniformLocation(ShaderHandler::shaderProgram, "mvp"), 1, GL_FALSE, glm::value_ptr(Camera::viewProjection * model));
-            glDrawArrays(GL_LINE_LOOP, 0, ui::visionConeVertices.size());
+            s_boids.push(pos, getVelocity(own), hue);
+            continue;
         }
-    }
 
-    glBindVertexArray(globalVars::VAO);
-    for (const BoidObject& boid : s_boids)
-    {
-        glUniform3fv(glGetUniformLocation(ShaderHandler::shaderProgram, "color"), 1, glm::value_ptr(getRGBFromHue(boid.m_hue)));
+        const std::array<float, 4> placement{ random::drawCentered(seed, random::Stream::spawn, id, 1) };
+        const glm::vec2 posNoise{ glm::vec2{ placement[0], placement[1] } * params.worldSize.x / 10.0f };
 
-        glm::mat4 model{ glm::translate(glm::mat4{ 1.0f }, glm::vec3{ boid.m_pos, 0.0f }) };
-        model = glm::rotate(model, boid.getRotation(), glm::vec3{ 0.0f, 0.0f, 1.0f });
-        glUniformMatrix4fv(glGetUniformLocation(ShaderHandler::shaderProgram, "mvp"), 1, GL_FALSE, glm::value_ptr(Camera::viewProjection * model));
-        glDrawArrays(GL_TRIANGLES, 0, 3);
+        s_boids.push(pos + posNoise, params.groupBoidsPointInSameDir ? groupVelocity : getVelocity(own), hue);
     }
+}
 
-    // Render m_pos as a point so we can see exactly where the boids are visible in a render cone
-    if (ui::showVisionCones)
+void simulation::boid::BoidObject::fillRenderSnapshot(const SimParams& params, RenderSnapshot& snapshot)
+{
+    const size_t numBoids{ s_boids.size() };
+    snapshot.worldSize = params.worldSize;
+    snapshot.positions.resize(numBoids);
+    snapshot.prevPositions.resize(numBoids);
+    snapshot.rotations.resize(numBoids);
+    snapshot.colors.resize(numBoids);
+
+    threadPool.parallelFor(numBoids, boidsPerChunk, [&](size_t begin, size_t end)
     {
-        glBindVertexArray(ui::visionConeVAO);
-        glUniform3fv(glGetUniformLocation(ShaderHandler::shaderProgram, "color"), 1, glm::value_ptr(glm::vec3{ 1.0f, 0.0f, 0.0f }));
-        for (const BoidObject& boid : s_boids)
+        for (size_t i{ begin }; i < end; ++i)
         {
-            glPointSize(globalVars::triangleWidth / 1.5f);
-            glm::mat4 model{ glm::translate(glm::mat4{ 1.0f }, glm::vec3{ boid.m_pos, 0.0f }) };
-            model = glm::rotate(model, boid.getRotation(), glm::vec3{ 0.0f, 0.0f, 1.0f });
-            glUniformMatrix4fv(glGetUniformLocation(ShaderHandler::shaderProgram, "mvp"), 1, GL_FALSE, glm::value_ptr(Camera::viewProjection * model));
-            glDrawArrays(GL_POINTS, 0, 1);
+            const BoidHandle boid{ s_boids[i] };
+            snapshot.positions[i] = boid.getPos();
+            snapshot.prevPositions[i] = s_boids.getPrevPos(i);
+            snapshot.rotations[i] = boid.getRotation(params.precision);
+            snapshot.colors[i] = getRGBFromHue(boid.getHue(), params.saturation, params.brightness);
         }
-    }
+    });
 }
-
-simulation::boid::BoidObject::BoidObject(glm::vec2 pos, glm::vec2 velocity, float hue)
-    : m_pos{ pos }
-    , m_velocity{ velocity }
-    , m_hue{ hue }
-{}
@@ -1,7 +1,10 @@
 #pragma once
 
-#include <GL/glew.h>
-#include <GLFW/glfw3.h>
+#include "BoidStore.h"
+#include "../RenderSnapshot.h"
+#include "../SimParams.h"
+#include "../TaskGraph.h"
+
 #include <glm/glm.hpp>
 #include <vector>
 
@@ -10,21 +13,15 @@ namespace simulation::boid
     class BoidObject
     {
         public:
-            static std::vector<BoidObject> s_boids;
-
-            static void updateBoids(float deltaTime);
-            static void createBoid(glm::vec2 pos);
-            static void renderAllBoids();
-            void setHue(float hue){ m_hue = hue; }
-
-            BoidObject(glm::vec2 pos, glm::vec2 velocity, float hue);
-
-        private:
-            glm::vec2 m_pos{ 0.0f };
-            glm::vec2 m_velocity{ 0.0f };
-            float m_hue{ 0.0f };
+            static BoidStore s_boids;
 
-            static void randomizeHues();
-            GLfloat getRotation() const { return -std::atan2(m_velocity.x, m_velocity.y); }
+            // Steps the flock with params, which get handed to every module the step calls into
+            static void updateBoids(const SimParams& params, float deltaTime);
+            // How long each part of the latest step took (see buildStepGraph in BoidObject.cpp)
+            static const std::vector<TaskGraph::Timing>& getStepTimings();
+            // Spawns params.numBoidsPerClick boids at pos
+            static void createBoid(const SimParams& params, glm::vec2 pos);
+            // Copies out what the render loop needs, on the simulation thread
+            static void fillRenderSnapshot(const SimParams& params, RenderSnapshot& snapshot);
     };
 }
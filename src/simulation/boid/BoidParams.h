@@ -1,18 +1,12 @@
 #pragma once
 
 #include "BoidObject.h"
-#include "../../Camera.h"
 
-#include <GL/glew.h>
-#include <GLFW/glfw3.h>
 #include <glm/glm.hpp>
 
-#include <vector>
-#include <random>
-
 namespace simulation::boid::globalVars
 {
-    extern GLuint VAO;
+    // The boids' size, which is also how far past the edge of the world they get before they wrap
     extern float triangleWidth;
     extern float triangleHeight;
 
@@ -29,18 +23,12 @@ namespace simulation::boid::globalVars
     extern float defaultVisionRadius;
     extern float visionRadius;
     extern float visionAngleCos;
+    constexpr float defaultVisionAngleDegrees{ 270.0f };
 
     extern float saturation;
     extern float brightness;
 
-    void init();
-    void recomputeVisionConeVBO();
-    void randomizeHues();
-
-    namespace rd
-    {
-        extern std::random_device rd;
-        extern std::mt19937 randomNumberGenerator;
-        extern std::uniform_real_distribution<float> centeredDistribution;
-    }
+    // Sizes and default forces, which all scale with the world size
+    void init(glm::vec2 worldSize);
+    void randomizeHues(const SimParams& params);
 }
@@ -0,0 +1,223 @@
+#include "BoidStore.h"
+
+namespace
+{
+    template<typename T>
+    void gather(simulation::boid::BoidStore::Array<T>& values, const std::vector<uint32_t>& order)
+    {
+        static simulation::boid::BoidStore::Array<T> permuteScratch{};
+        permuteScratch.resize(values.size());
+        for (size_t i{ 0 }; i < order.size(); ++i)
+            permuteScratch[i] = values[order[i]];
+
+        values.swap(permuteScratch);
+    }
+
+    // Frees the memory too, so switching to compact actually gets the float arrays back
+    template<typename T>
+    void release(simulation::boid::BoidStore::Array<T>& values)
+    {
+        simulation::boid::BoidStore::Array<T>{}.swap(values);
+    }
+}
+
+void simulation::boid::BoidStore::clear()
+{
+    m_posX.clear();
+    m_posY.clear();
+    m_velX.clear();
+    m_velY.clear();
+    m_hue.clear();
+    m_prevPosX.clear();
+    m_prevPosY.clear();
+    m_compactPosX.clear();
+    m_compactPosY.clear();
+    m_compactVelX.clear();
+    m_compactVelY.clear();
+    m_compactHue.clear();
+    m_compactPrevPosX.clear();
+    m_compactPrevPosY.clear();
+    m_id.clear();
+    m_flockForceX.clear();
+    m_flockForceY.clear();
+    m_flockHue.clear();
+    m_hasFlockCache.clear();
+}
+
+void simulation::boid::BoidStore::reserve(size_t capacity)
+{
+    if (m_storage == Storage::full)
+    {
+        m_posX.reserve(capacity);
+        m_posY.reserve(capacity);
+        m_velX.reserve(capacity);
+        m_velY.reserve(capacity);
+        m_hue.reserve(capacity);
+        m_prevPosX.reserve(capacity);
+        m_prevPosY.reserve(capacity);
+    }
+    else
+    {
+        m_compactPosX.reserve(capacity);
+        m_compactPosY.reserve(capacity);
+        m_compactVelX.reserve(capacity);
+        m_compactVelY.reserve(capacity);
+        m_compactHue.reserve(capacity);
+        m_compactPrevPosX.reserve(capacity);
+        m_compactPrevPosY.reserve(capacity);
+    }
+
+    m_id.reserve(capacity);
+    m_flockForceX.reserve(capacity);
+    m_flockForceY.reserve(capacity);
+    m_flockHue.reserve(capacity);
+    m_hasFlockCache.reserve(capacity);
+}
+
+void simulation::boid::BoidStore::push(glm::vec2 pos, glm::vec2 velocity, float hue)
+{
+    if (m_storage == Storage::full)
+    {
+        m_posX.push_back(pos.x);
+        m_posY.push_back(pos.y);
+        m_velX.push_back(velocity.x);
+        m_velY.push_back(velocity.y);
+        m_hue.push_back(hue);
+        m_prevPosX.push_back(pos.x);
+        m_prevPosY.push_back(pos.y);
+    }
+    else
+    {
+        m_compactPosX.push_back(0);
+        m_compactPosY.push_back(0);
+        m_compactVelX.push_back(0);
+        m_compactVelY.push_back(0);
+        m_compactHue.push_back(0);
+        m_compactPrevPosX.push_back(0);
+        m_compactPrevPosY.push_back(0);
+
+        const size_t index{ m_compactHue.size() - 1 };
+        setPos(index, pos);
+        setVelocity(index, velocity);
+        setHue(index, hue);
+        setPrevPos(index, pos);
+    }
+
+    m_id.push_back(m_nextId++);
+    m_flockForceX.push_back(0.0f);
+    m_flockForceY.push_back(0.0f);
+    m_flockHue.push_back(-1.0f);
+    m_hasFlockCache.push_back(0);
+}
+
+void simulation::boid::BoidStore::permute(const std::vector<uint32_t>& order)
+{
+    if (m_storage == Storage::full)
+    {
+        gather(m_posX, order);
+        gather(m_posY, order);
+        gather(m_velX, order);
+        gather(m_velY, order);
+        gather(m_hue, order);
+        gather(m_prevPosX, order);
+        gather(m_prevPosY, order);
+    }
+    else
+    {
+        gather(m_compactPosX, order);
+        gather(m_compactPosY, order);
+        gather(m_compactVelX, order);
+        gather(m_compactVelY, order);
+        gather(m_compactHue, order);
+        gather(m_compactPrevPosX, order);
+        gather(m_compactPrevPosY, order);
+    }
+
+    gather(m_id, order);
+    gather(m_flockForceX, order);
+    gather(m_flockForceY, order);
+    gather(m_flockHue, order);
+    gather(m_hasFlockCache, order);
+}
+
+void simulation::boid::BoidStore::setStorage(Storage storage, glm::vec2 worldSize)
+{
+    if (storage == m_storage && worldSize == m_worldSize)
+        return;
+
+    // Go through floats either way, so a new world size re-quantizes the compact positions
+    const size_t numBoids{ size() };
+    if (m_storage == Storage::compact)
+    {
+        m_posX.resize(numBoids);
+        m_posY.resize(numBoids);
+        m_velX.resize(numBoids);
+        m_velY.resize(numBoids);
+        m_hue.resize(numBoids);
+        m_prevPosX.resize(numBoids);
+        m_prevPosY.resize(numBoids);
+
+        for (size_t i{ 0 }; i < numBoids; ++i)
+        {
+            const glm::vec2 pos{ getPos(i) };
+            const glm::vec2 velocity{ getVelocity(i) };
+            const glm::vec2 prevPos{ getPrevPos(i) };
+            m_posX[i] = pos.x;
+            m_posY[i] = pos.y;
+            m_velX[i] = velocity.x;
+            m_velY[i] = velocity.y;
+            m_hue[i] = getHue(i);
+            m_prevPosX[i] = prevPos.x;
+            m_prevPosY[i] = prevPos.y;
+        }
+
+        release(m_compactPosX);
+        release(m_compactPosY);
+        release(m_compactVelX);
+        release(m_compactVelY);
+        release(m_compactHue);
+        release(m_compactPrevPosX);
+        release(m_compactPrevPosY);
+        m_storage = Storage::full;
+    }
+
+    m_worldSize = worldSize;
+    const glm::vec2 margin{ worldSize / 16.0f };
+    m_quantizeOrigin = -margin;
+    m_quantizeStep = glm::max(worldSize + 2.0f * margin, glm::vec2{ 1.0f }) / 65535.0f;
+
+    if (storage == Storage::full)
+        return;
+
+    m_compactPosX.resize(numBoids);
+    m_compactPosY.resize(numBoids);
+    m_compactVelX.resize(numBoids);
+    m_compactVelY.resize(numBoids);
+    m_compactHue.resize(numBoids);
+    m_compactPrevPosX.resize(numBoids);
+    m_compactPrevPosY.resize(numBoids);
+
+    m_storage = Storage::compact;
+    for (size_t i{ 0 }; i < numBoids; ++i)
+    {
+        setPos(i, { m_posX[i], m_posY[i] });
+        setVelocity(i, { m_velX[i], m_velY[i] });
+        setHue(i, m_hue[i]);
+        setPrevPos(i, { m_prevPosX[i], m_prevPosY[i] });
+    }
+
+    release(m_posX);
+    release(m_posY);
+    release(m_velX);
+    release(m_velY);
+    release(m_hue);
+    release(m_prevPosX);
+    release(m_prevPosY);
+}
+
+size_t simulation::boid::BoidStore::getBytesPerBoid() const
+{
+    // Position, velocity, hue and previous position
+    const size_t stateBytes{ m_storage == Storage::full ? 7 * sizeof(float) : 7 * sizeof(uint16_t) };
+    return stateBytes + sizeof(uint32_t) + 3 * sizeof(float) + sizeof(uint8_t);
+}
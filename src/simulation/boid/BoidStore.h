@@ -0,0 +1,235 @@
+#pragma once
+
+#include "../AlignedAllocator.h"
+#include "../FastMath.h"
+#include "../HalfFloat.h"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace simulation::boid
+{
+    class BoidStore;
+
+    // Thin reference to a single boid in a BoidStore. Only valid until the store is resized or reordered
+    class BoidHandle
+    {
+        public:
+            BoidHandle(BoidStore& store, size_t index) : m_store{ &store }, m_index{ index } {}
+
+            glm::vec2 getPos() const;
+            void setPos(glm::vec2 pos);
+            glm::vec2 getVelocity() const;
+            void setVelocity(glm::vec2 velocity);
+            float getHue() const;
+            void setHue(float hue);
+
+            float getRotation(fastmath::Precision precision) const { const glm::vec2 velocity{ getVelocity() }; return -fastmath::atan2(precision, velocity.x, velocity.y); }
+            size_t getIndex() const { return m_index; }
+
+        private:
+            BoidStore* m_store;
+            size_t m_index;
+    };
+
+    // Structure-of-arrays storage for the boids. Each field is its own cache line aligned array so that the hot loops
+    // only pull in the fields they actually read, and so the arrays can be loaded straight into SIMD registers.
+    //
+    // The positions, velocities and hues can be kept either as floats (full) or packed into 16 bits each (compact). Compact
+    // quantizes the positions to 65536 steps across the world (with a 1/16 margin on each side for boids that are past
+    // the edge and about to wrap), stores the velocities as half floats and the hues as 16 bit fractions of a turn. That
+    // takes the state the render and gather passes stream through from 28 bytes a boid to 14, at the cost of positions
+    // only being good to about 1/30 of a pixel on a 1920 wide screen and speeds to 3 significant digits
+    class BoidStore
+    {
+        public:
+            template<typename T>
+            using Array = std::vector<T, AlignedAllocator<T>>;
+
+            enum class Storage
+            {
+                full,
+                compact,
+            };
+
+            size_t size() const { return m_id.size(); }
+            bool empty() const { return m_id.empty(); }
+            void clear();
+            void reserve(size_t capacity);
+            void push(glm::vec2 pos, glm::vec2 velocity, float hue);
+
+            // Reorders the boids so that boid i becomes the boid that was at order[i]
+            void permute(const std::vector<uint32_t>& order);
+
+            // Converts every boid to the given storage. worldSize is what the compact positions get quantized over, so this
+            // has to be called again if the screen size changes
+            void setStorage(Storage storage, glm::vec2 worldSize);
+            Storage getStorage() const { return m_storage; }
+            glm::vec2 getWorldSize() const { return m_worldSize; }
+            // Bytes of per-boid arrays with the current storage
+            size_t getBytesPerBoid() const;
+
+            BoidHandle operator[](size_t index) { return { *this, index }; }
+
+            glm::vec2 getPos(size_t index) const
+            {
+                if (m_storage == Storage::full)
+                    return { m_posX[index], m_posY[index] };
+
+                return unpackPos(m_compactPosX[index], m_compactPosY[index]);
+            }
+
+            glm::vec2 getVelocity(size_t index) const
+            {
+                if (m_storage == Storage::full)
+                    return { m_velX[index], m_velY[index] };
+
+                return { halffloat::toFloat(m_compactVelX[index]), halffloat::toFloat(m_compactVelY[index]) };
+            }
+
+            float getHue(size_t index) const
+            {
+                if (m_storage == Storage::full)
+                    return m_hue[index];
+
+                return static_cast<float>(m_compactHue[index]) * (1.0f / 65536.0f);
+            }
+
+            // Where each boid was before the last step, so rendering can draw it somewhere between the last two steps
+            glm::vec2 getPrevPos(size_t index) const
+            {
+                if (m_storage == Storage::full)
+                    return { m_prevPosX[index], m_prevPosY[index] };
+
+                return unpackPos(m_compactPrevPosX[index], m_compactPrevPosY[index]);
+            }
+
+            void setPos(size_t index, glm::vec2 pos)
+            {
+                if (m_storage == Storage::full)
+                {
+                    m_posX[index] = pos.x;
+                    m_posY[index] = pos.y;
+                    return;
+                }
+
+                m_compactPosX[index] = packCoordinate(pos.x, 0);
+                m_compactPosY[index] = packCoordinate(pos.y, 1);
+            }
+
+            void setVelocity(size_t index, glm::vec2 velocity)
+            {
+                if (m_storage == Storage::full)
+                {
+                    m_velX[index] = velocity.x;
+                    m_velY[index] = velocity.y;
+                    return;
+                }
+
+                m_compactVelX[index] = halffloat::fromFloat(velocity.x);
+                m_compactVelY[index] = halffloat::fromFloat(velocity.y);
+            }
+
+            // hue has to be in [0, 1)
+            void setHue(size_t index, float hue)
+            {
+                if (m_storage == Storage::full)
+                {
+                    m_hue[index] = hue;
+                    return;
+                }
+
+                // Rounding up to 65536 wraps around to 0, which is the same hue
+                m_compactHue[index] = static_cast<uint16_t>(static_cast<uint32_t>(hue * 65536.0f + 0.5f));
+            }
+
+            void setPrevPos(size_t index, glm::vec2 pos)
+            {
+                if (m_storage == Storage::full)
+                {
+                    m_prevPosX[index] = pos.x;
+                    m_prevPosY[index] = pos.y;
+                    return;
+                }
+
+                m_compactPrevPosX[index] = packCoordinate(pos.x, 0);
+                m_compactPrevPosY[index] = packCoordinate(pos.y, 1);
+            }
+
+            // The float arrays, for loops that want to stream through them directly. Only valid with full storage (they're
+            // empty with compact), everything else has to go through the accessors above
+            float* posX() { return m_posX.data(); }
+            float* posY() { return m_posY.data(); }
+            float* velX() { return m_velX.data(); }
+            float* velY() { return m_velY.data(); }
+            float* prevPosX() { return m_prevPosX.data(); }
+            float* prevPosY() { return m_prevPosY.data(); }
+
+            // Every boid gets its own id, handed out in the order they're added. It stays with the boid when the store gets
+            // reordered, so it's what the random number streams and the staggered update phases get keyed on
+            const uint32_t* id() const { return m_id.data(); }
+            uint32_t getNextId() const { return m_nextId; }
+
+            // Flocking steering cached between staggered updates (see params.flockUpdateInterval). flockHue is the average hue
+            // of the boids it could see, or -1 if it couldn't see any. hasFlockCache is 0 until a boid's first update
+            float* flockForceX() { return m_flockForceX.data(); }
+            float* flockForceY() { return m_flockForceY.data(); }
+            float* flockHue() { return m_flockHue.data(); }
+            uint8_t* hasFlockCache() { return m_hasFlockCache.data(); }
+
+        private:
+            glm::vec2 unpackPos(uint16_t x, uint16_t y) const
+            {
+                return m_quantizeOrigin + glm::vec2{ static_cast<float>(x), static_cast<float>(y) } * m_quantizeStep;
+            }
+
+            // Anything outside the quantized range gets clamped to its edge
+            uint16_t packCoordinate(float value, int axis) const
+            {
+                const float steps{ (value - m_quantizeOrigin[axis]) / m_quantizeStep[axis] + 0.5f };
+                return static_cast<uint16_t>(std::clamp(steps, 0.0f, 65535.0f));
+            }
+
+            Storage m_storage{ Storage::full };
+            glm::vec2 m_worldSize{ 0.0f };
+            glm::vec2 m_quantizeOrigin{ 0.0f };
+            glm::vec2 m_quantizeStep{ 1.0f };
+
+            // Full storage
+            Array<float> m_posX{};
+            Array<float> m_posY{};
+            Array<float> m_velX{};
+            Array<float> m_velY{};
+            Array<float> m_hue{};
+            Array<float> m_prevPosX{};
+            Array<float> m_prevPosY{};
+
+            // Compact storage
+            Array<uint16_t> m_compactPosX{};
+            Array<uint16_t> m_compactPosY{};
+            Array<uint16_t> m_compactVelX{};
+            Array<uint16_t> m_compactVelY{};
+            Array<uint16_t> m_compactHue{};
+            Array<uint16_t> m_compactPrevPosX{};
+            Array<uint16_t> m_compactPrevPosY{};
+
+            Array<uint32_t> m_id{};
+            uint32_t m_nextId{ 0 };
+
+            Array<float> m_flockForceX{};
+            Array<float> m_flockForceY{};
+            Array<float> m_flockHue{};
+            Array<uint8_t> m_hasFlockCache{};
+    };
+
+    inline glm::vec2 BoidHandle::getPos() const { return m_store->getPos(m_index); }
+    inline void BoidHandle::setPos(glm::vec2 pos) { m_store->setPos(m_index, pos); }
+    inline glm::vec2 BoidHandle::getVelocity() const { return m_store->getVelocity(m_index); }
+    inline void BoidHandle::setVelocity(glm::vec2 velocity) { m_store->setVelocity(m_index, velocity); }
+    inline float BoidHandle::getHue() const { return m_store->getHue(m_index); }
+    inline void BoidHandle::setHue(float hue) { m_store->setHue(m_index, hue); }
+}
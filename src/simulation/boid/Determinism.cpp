@@ -0,0 +1,73 @@
+#include "Determinism.h"
+#include "BoidObject.h"
+#include "../ThreadPool.h"
+
+#include <atomic>
+#include <bit>
+
+namespace
+{
+    constexpr size_t boidsPerChunk{ 4096 };
+
+    // splitmix64's finalizer
+    uint64_t mix(uint64_t x)
+    {
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+        return x ^ (x >> 31);
+    }
+
+    uint64_t combine(uint64_t hash, float value)
+    {
+        return mix(hash ^ std::bit_cast<uint32_t>(value));
+    }
+}
+
+namespace simulation::boid::determinism
+{
+    uint64_t lastStateHash{ 0 };
+    uint64_t lastHashedStep{ 0 };
+
+    uint64_t hashState()
+    {
+        BoidStore& boids{ BoidObject::s_boids };
+        const uint32_t* const ids{ boids.id() };
+        const float* const flockForceX{ boids.flockForceX() };
+        const float* const flockForceY{ boids.flockForceY() };
+        const float* const flockHue{ boids.flockHue() };
+        const uint8_t* const hasFlockCache{ boids.hasFlockCache() };
+
+        // Wrapping addition doesn't care about order either, so the chunks can finish in any order
+        std::atomic<uint64_t> total{ mix(boids.size()) };
+        threadPool.parallelFor(boids.size(), boidsPerChunk, [&](size_t begin, size_t end)
+        {
+            uint64_t chunkTotal{ 0 };
+            for (size_t i{ begin }; i < end; ++i)
+            {
+                const glm::vec2 pos{ boids.getPos(i) };
+                const glm::vec2 velocity{ boids.getVelocity(i) };
+
+                uint64_t hash{ mix(ids[i] + 0x9e3779b97f4a7c15ull) };
+                hash = combine(hash, pos.x);
+                hash = combine(hash, pos.y);
+                hash = combine(hash, velocity.x);
+                hash = combine(hash, velocity.y);
+                hash = combine(hash, boids.getHue(i));
+                hash = combine(hash, flockForceX[i]);
+                hash = combine(hash, flockForceY[i]);
+                hash = combine(hash, flockHue[i]);
+                chunkTotal += mix(hash ^ hasFlockCache[i]);
+            }
+
+            total += chunkTotal;
+        });
+
+        return total;
+    }
+
+    void recordStep(uint64_t step)
+    {
+        lastStateHash = hashState();
+        lastHashedStep = step;
+    }
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdint>
+
+// Support for the deterministic mode (params.deterministic). In that mode updateBoids takes the random seed from
+// params.deterministicSeed and sums every boid's neighbors with kernel::sumNeighborsDeterministic, which adds each pair's
+// terms up in fixed point so that the result doesn't depend on the order the neighbors get visited in. Everything else in a
+// step already only depends on the boid being updated (each thread writes its own boids, and the random numbers are keyed
+// on id and step), so the state after a step comes out byte for byte the same with any number of threads, with or without
+// Morton reordering, and whichever SIMD kernel the CPU would otherwise pick. tests/DeterminismCheck.cmake checks that
+// through boids_headless.
+//
+// The far-field approximation, the symmetric pass and the ghost cells all sum in their own order, so
+// they're skipped while it's on.
+//
+// Runs are only comparable between the same build on the same kind of CPU: a different compiler can round the per-pair
+// float math differently
+namespace simulation::boid::determinism
+{
+    // Hash of the state after the latest step in deterministic mode, and which step that was. For the UI
+    extern uint64_t lastStateHash;
+    extern uint64_t lastHashedStep;
+
+    // Hash of everything the next step reads from every boid: position, velocity, hue and the cached flocking steering.
+    // Each boid gets hashed on its own (keyed on its id) and the results get added up, so the store order doesn't matter
+    uint64_t hashState();
+
+    // Hashes the state into lastStateHash. Called by updateBoids at the end of a deterministic step
+    void recordStep(uint64_t step);
+}
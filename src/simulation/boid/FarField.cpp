@@ -0,0 +1,415 @@
+#include "FarField.h"
+#include "BoidObject.h"
+#include "BoidParams.h"
+#include "SpatialGrid.h"
+#include "../SimParams.h"
+#include "../ThreadPool.h"
+
+#include <glm/gtc/constants.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <vector>
+
+namespace
+{
+    using simulation::boid::kernel::NeighborSums;
+    using simulation::SimParams;
+    namespace grid = simulation::boid::grid;
+
+    // Level 0 is the leaves (64x64), every level above has half as many cells per axis, and the top level is 4x4
+    constexpr int numLevels{ 5 };
+    constexpr int leafCellsPerAxis{ 1 << (numLevels + 1) };
+    constexpr int topCellsPerAxis{ leafCellsPerAxis >> (numLevels - 1) };
+
+    // Every node popped off the stack pushes at most 4 children, so this covers the 16 top level nodes plus 3 per level
+    constexpr size_t maxStackSize{ topCellsPerAxis * topCellsPerAxis + 3 * numLevels };
+
+    // Nodes smaller than this (relative to the vision radius) don't get opened any further. All of their boids go straight
+    // into the SIMD kernel, which is cheaper than walking the last few levels for them
+    constexpr float smallestOpenedNode{ 1.0f / 4.0f };
+
+    constexpr size_t errorSampleSize{ 1024 };
+
+    // Slack for float rounding in the vision cone culling
+    constexpr float cullMargin{ 1e-4f };
+
+    struct Node
+    {
+        glm::vec2 centroid{ 0.0f };
+        glm::vec2 headingSum{ 0.0f };
+        float hueCosSum{ 0.0f };
+        float hueSinSum{ 0.0f };
+        unsigned int count{ 0 };
+    };
+
+    // levels[l] has leafCellsPerAxis >> l cells per axis, in Morton order. The children of node m are nodes 4m to 4m + 3
+    // on the level below, so every node covers a contiguous run of leaves
+    std::array<std::vector<Node>, numLevels> levels{};
+
+    // Boids sorted by leaf cell in Morton order (counting sort), same layout as grid::cellStart and grid::sortedIndices.
+    // Node m on level l covers the boids leafStart[m << 2l] up to leafStart[(m + 1) << 2l]
+    std::vector<unsigned int> leafStart{};
+    std::vector<unsigned int> leafIndices{};
+    std::vector<unsigned int> boidLeaves{};
+
+    // The boids' positions, headings and hue vectors in leaf order, so the boids in the leaves that get opened up are
+    // contiguous runs the SIMD kernels can go through
+    simulation::boid::kernel::NeighborData leafData{};
+
+    // Filled in by update() so the traversal doesn't have to divide
+    std::array<glm::vec2, numLevels> cellSizes{};
+
+    int getCellsPerAxis(int level) { return leafCellsPerAxis >> level; }
+    float getCellWidth(const SimParams& params, int level) { return params.worldSize.x / getCellsPerAxis(level); }
+    float getCellHeight(const SimParams& params, int level) { return params.worldSize.y / getCellsPerAxis(level); }
+
+    int wrapCell(int cell, int numCells)
+    {
+        cell %= numCells;
+        return cell < 0 ? cell + numCells : cell;
+    }
+
+    // Interleaves the bits of x and y (x in the even bits)
+    unsigned int getMortonCode(int x, int y)
+    {
+        unsigned int code{ 0 };
+        for (int bit{ 0 }; bit < numLevels + 1; ++bit)
+            code |= ((static_cast<unsigned int>(x) >> bit & 1u) << (bit * 2)) | ((static_cast<unsigned int>(y) >> bit & 1u) << (bit * 2 + 1));
+        return code;
+    }
+
+    unsigned int getLeaf(const SimParams& params, glm::vec2 pos)
+    {
+        const int x{ wrapCell(static_cast<int>(std::floor(pos.x / getCellWidth(params, 0))), leafCellsPerAxis) };
+        const int y{ wrapCell(static_cast<int>(std::floor(pos.y / getCellHeight(params, 0))), leafCellsPerAxis) };
+        return getMortonCode(x, y);
+    }
+
+    // Wraps value into [-extent / 2, extent / 2]. Only works within one and a half extents of 0, which covers everything here
+    float wrapCentered(float value, float extent)
+    {
+        if (value > extent / 2.0f)
+            return value - extent;
+        if (value < -extent / 2.0f)
+            return value + extent;
+        return value;
+    }
+
+    void sortIntoLeaves(const SimParams& params)
+    {
+        const simulation::boid::BoidStore& boids{ simulation::boid::BoidObject::s_boids };
+        boidLeaves.resize(boids.size());
+        leafIndices.resize(boids.size());
+        leafStart.assign(leafCellsPerAxis * leafCellsPerAxis + 1, 0);
+
+        for (size_t i{ 0 }; i < boids.size(); ++i)
+        {
+            boidLeaves[i] = getLeaf(params, boids.getPos(i));
+            ++leafStart[boidLeaves[i] + 1];
+        }
+
+        for (size_t c{ 1 }; c < leafStart.size(); ++c)
+            leafStart[c] += leafStart[c - 1];
+
+        for (size_t i{ 0 }; i < boids.size(); ++i)
+            leafIndices[leafStart[boidLeaves[i]]++] = static_cast<unsigned int>(i);
+
+        for (size_t c{ leafStart.size() - 1 }; c > 0; --c)
+            leafStart[c] = leafStart[c - 1];
+        leafStart[0] = 0;
+    }
+
+    void buildLeaves(const SimParams& params)
+    {
+        std::vector<Node>& leaves{ levels[0] };
+        leaves.assign(leafCellsPerAxis * leafCellsPerAxis, Node{});
+
+        simulation::threadPool.parallelFor(leafCellsPerAxis, 1, [&](size_t begin, size_t end)
+        {
+            for (int y{ static_cast<int>(begin) }; y < static_cast<int>(end); ++y)
+            {
+                for (int x{ 0 }; x < leafCellsPerAxis; ++x)
+                {
+                    const unsigned int leaf{ getMortonCode(x, y) };
+                    Node& node{ leaves[leaf] };
+                    const glm::vec2 cellMin{ x * getCellWidth(params, 0), y * getCellHeight(params, 0) };
+
+                    // Positions get averaged relative to the cell, with wraparound, so a boid that's just wrapped around (and
+                    // is sitting a little past the edge of the screen) still counts as being in this cell
+                    glm::vec2 offsetSum{ 0.0f };
+                    for (unsigned int k{ leafStart[leaf] }; k < leafStart[leaf + 1]; ++k)
+                    {
+                        const glm::vec2 offset{ glm::vec2{ leafData.posX[k], leafData.posY[k] } - cellMin };
+                        offsetSum += glm::vec2{ wrapCentered(offset.x, params.worldSize.x), wrapCentered(offset.y, params.worldSize.y) };
+                        node.headingSum += glm::vec2{ leafData.headingX[k], leafData.headingY[k] };
+                        node.hueCosSum += leafData.hueCos[k];
+                        node.hueSinSum += leafData.hueSin[k];
+                    }
+
+                    node.count = leafStart[leaf + 1] - leafStart[leaf];
+                    if (node.count > 0)
+                        node.centroid = cellMin + offsetSum / static_cast<float>(node.count);
+                }
+            }
+        });
+    }
+
+    void buildLevel(int level)
+    {
+        const std::vector<Node>& children{ levels[level - 1] };
+        std::vector<Node>& nodes{ levels[level] };
+        nodes.assign(children.size() / 4, Node{});
+
+        for (size_t m{ 0 }; m < nodes.size(); ++m)
+        {
+            Node& node{ nodes[m] };
+            glm::vec2 weightedCentroids{ 0.0f };
+            for (size_t child{ m * 4 }; child < m * 4 + 4; ++child)
+            {
+                weightedCentroids += children[child].centroid * static_cast<float>(children[child].count);
+                node.headingSum += children[child].headingSum;
+                node.hueCosSum += children[child].hueCosSum;
+                node.hueSinSum += children[child].hueSinSum;
+                node.count += children[child].count;
+            }
+
+            if (node.count > 0)
+                node.centroid = weightedCentroids / static_cast<float>(node.count);
+        }
+    }
+
+    // Distance from 0 to the closest point of [min, max] on one axis, where the range can cross the point half a screen
+    // away and wrap around to the other side
+    float getClosestOnAxis(float min, float max, float extent)
+    {
+        const auto getClosest{ [](float low, float high) { return low > 0.0f ? low : (high < 0.0f ? -high : 0.0f); } };
+        if (max > extent / 2.0f)
+            return std::min(getClosest(min, extent / 2.0f), getClosest(-extent / 2.0f, max - extent));
+        if (min < -extent / 2.0f)
+            return std::min(getClosest(min + extent, extent / 2.0f), getClosest(-extent / 2.0f, max));
+        return getClosest(min, max);
+    }
+
+    enum class ConeOverlap
+    {
+        outside,
+        partial,
+        inside,
+    };
+
+    // How the box [min, max] (relative to the boid, not containing it) overlaps the vision cone. A box that doesn't contain
+    // the boid covers less than 180 degrees as seen from the boid, from the direction of its most clockwise corner round to
+    // its most counterclockwise one. The box is inside the cone if both of those are and the range doesn't go through the
+    // blind spot directly behind the boid, and outside if neither is and the range doesn't go through the heading
+    ConeOverlap getConeOverlap(const SimParams& params, glm::vec2 min, glm::vec2 max, glm::vec2 heading)
+    {
+        if (params.visionAngleCos <= -1.0f)
+            return ConeOverlap::inside;
+
+        const auto cross{ [](glm::vec2 a, glm::vec2 b) { return a.x * b.y - a.y * b.x; } };
+        const std::array<glm::vec2, 4> corners{ min, glm::vec2{ max.x, min.y }, max, glm::vec2{ min.x, max.y } };
+
+        glm::vec2 first{ corners[0] };
+        glm::vec2 last{ corners[0] };
+        for (const glm::vec2 corner : corners)
+        {
+            if (cross(first, corner) < 0.0f)
+                first = corner;
+            if (cross(last, corner) > 0.0f)
+                last = corner;
+        }
+
+        const auto isInRange{ [&](glm::vec2 dir) { return cross(first, dir) >= 0.0f && cross(dir, last) >= 0.0f; } };
+        const auto getConeMargin{ [&](glm::vec2 corner) { return glm::dot(heading, corner) - params.visionAngleCos * glm::length(corner); } };
+        const float firstMargin{ getConeMargin(first) };
+        const float lastMargin{ getConeMargin(last) };
+
+        if (firstMargin >= 0.0f && lastMargin >= 0.0f && !isInRange(-heading))
+            return ConeOverlap::inside;
+
+        // Only cull when the corners are clearly outside, so float rounding can't throw out a boid the per-pair test keeps
+        if (firstMargin < -cullMargin * glm::length(first) && lastMargin < -cullMargin * glm::length(last) && !isInRange(heading))
+            return ConeOverlap::outside;
+
+        return ConeOverlap::partial;
+    }
+
+    void addNode(const SimParams& params, NeighborSums& sums, const Node& node, glm::vec2 pos, glm::vec2 vecToCentroid, float distance)
+    {
+        const float count{ static_cast<float>(node.count) };
+        const float strength{ glm::clamp((params.visionRadius - distance) / params.visionRadius, 0.0f, 1.0f) };
+
+        sums.numVisible += node.count;
+        sums.separation += -(vecToCentroid / distance) * strength * count;
+        sums.alignment += node.headingSum * strength;
+        sums.cohesion += (pos + vecToCentroid) * count;
+        sums.hueSin += node.hueSinSum;
+        sums.hueCos += node.hueCosSum;
+    }
+
+    void measureError(const SimParams& params)
+    {
+        using namespace simulation::boid;
+
+        const BoidStore& boids{ BoidObject::s_boids };
+        farfield::ErrorStats stats{};
+        const size_t stride{ std::max<size_t>(boids.size() / errorSampleSize, 1) };
+
+        for (size_t i{ 0 }; i < boids.size(); i += stride)
+        {
+            const glm::vec2 pos{ boids.getPos(i) };
+            const glm::vec2 velocity{ boids.getVelocity(i) };
+            const NeighborSums exact{ kernel::sumNeighborsScalar(params, pos, velocity, grid::getNeighborCells(pos)) };
+            if (exact.numVisible == 0)
+                continue;
+
+            const NeighborSums approximate{ farfield::sumNeighbors(params, pos, velocity) };
+            // Every boid adds at most 1 to the separation and alignment sums, and the average position is always within the
+            // vision radius
+            const float numVisible{ static_cast<float>(exact.numVisible) };
+            const float separationError{ glm::length(approximate.separation - exact.separation) / numVisible };
+            const float alignmentError{ glm::length(approximate.alignment - exact.alignment) / numVisible };
+            const float cohesionError{ approximate.numVisible == 0 ? 1.0f :
+                glm::length(approximate.cohesion / static_cast<float>(approximate.numVisible) - exact.cohesion / numVisible) / params.visionRadius };
+
+            stats.meanSeparation += separationError;
+            stats.maxSeparation = std::max(stats.maxSeparation, separationError);
+            stats.meanAlignment += alignmentError;
+            stats.maxAlignment = std::max(stats.maxAlignment, alignmentError);
+            stats.meanCohesion += cohesionError;
+            stats.maxCohesion = std::max(stats.maxCohesion, cohesionError);
+            ++stats.numSampled;
+        }
+
+        if (stats.numSampled > 0)
+        {
+            stats.meanSeparation /= static_cast<float>(stats.numSampled);
+            stats.meanAlignment /= static_cast<float>(stats.numSampled);
+            stats.meanCohesion /= static_cast<float>(stats.numSampled);
+        }
+
+        farfield::lastError = stats;
+    }
+}
+
+namespace simulation::boid::farfield
+{
+    bool errorMeasurementRequested{ false };
+    ErrorStats lastError{};
+
+    void update(const SimParams& params)
+    {
+        for (int level{ 0 }; level < numLevels; ++level)
+            cellSizes[level] = glm::vec2{ getCellWidth(params, level), getCellHeight(params, level) };
+
+        sortIntoLeaves(params);
+        kernel::gatherNeighborData(params, leafData, leafIndices);
+        buildLeaves(params);
+        for (int level{ 1 }; level < numLevels; ++level)
+            buildLevel(level);
+
+        if (errorMeasurementRequested)
+        {
+            measureError(params);
+            errorMeasurementRequested = false;
+        }
+    }
+
+    kernel::NeighborSums sumNeighbors(const SimParams& params, glm::vec2 pos, glm::vec2 velocity)
+    {
+        struct StackEntry
+        {
+            int level;
+            int x;
+            int y;
+            unsigned int code;
+        };
+
+        const glm::vec2 heading{ glm::normalize(velocity) };
+        const glm::vec2 screenSize{ params.worldSize };
+        const float radiusSquared{ params.visionRadius * params.visionRadius };
+
+        // Nodes that didn't get approximated or culled. The boids in them go through the exact per-pair test at the end
+        thread_local std::vector<kernel::Range> openedNodes{};
+        openedNodes.clear();
+
+        NeighborSums sums{};
+        std::array<StackEntry, maxStackSize> stack;
+        size_t stackSize{ 0 };
+        for (int y{ 0 }; y < topCellsPerAxis; ++y)
+        {
+            for (int x{ 0 }; x < topCellsPerAxis; ++x)
+            {
+                const unsigned int code{ getMortonCode(x, y) };
+                if (levels[numLevels - 1][code].count > 0)
+                    stack[stackSize++] = { numLevels - 1, x, y, code };
+            }
+        }
+
+        while (stackSize > 0)
+        {
+            const StackEntry entry{ stack[--stackSize] };
+            const Node& node{ levels[entry.level][entry.code] };
+
+            // The box relative to the boid, using the copy of it that's closest to the boid
+            const glm::vec2 cellSize{ cellSizes[entry.level] };
+            const glm::vec2 cellMin{ entry.x * cellSize.x, entry.y * cellSize.y };
+            const glm::vec2 toCenter{ cellMin + cellSize / 2.0f - pos };
+            const glm::vec2 shift{ glm::vec2{ wrapCentered(toCenter.x, screenSize.x), wrapCentered(toCenter.y, screenSize.y) } - toCenter };
+            const glm::vec2 min{ cellMin + shift - pos };
+            const glm::vec2 max{ min + cellSize };
+
+            const glm::vec2 closest{ getClosestOnAxis(min.x, max.x, screenSize.x), getClosestOnAxis(min.y, max.y, screenSize.y) };
+            if (glm::dot(closest, closest) > radiusSquared)
+                continue;
+
+            // If the box crosses the point halfway around the screen from the boid, the boids in it wrap around to
+            // different sides, so it can't be approximated as a whole (or culled by the vision cone)
+            const bool straddlesWrap{ min.x < -screenSize.x / 2.0f || max.x > screenSize.x / 2.0f || min.y < -screenSize.y / 2.0f || max.y > screenSize.y / 2.0f };
+            if (!straddlesWrap)
+            {
+                const ConeOverlap coneOverlap{ closest == glm::vec2{ 0.0f } ? ConeOverlap::partial : getConeOverlap(params, min, max, heading) };
+                if (coneOverlap == ConeOverlap::outside)
+                    continue;
+
+                const glm::vec2 furthest{ std::max(-min.x, max.x), std::max(-min.y, max.y) };
+                if (coneOverlap == ConeOverlap::inside && glm::dot(furthest, furthest) <= radiusSquared)
+                {
+                    const glm::vec2 vecToCentroid{ node.centroid + shift - pos };
+                    const float distance{ glm::length(vecToCentroid) };
+                    if (std::max(cellSize.x, cellSize.y) < params.farFieldOpeningAngle * distance)
+                    {
+                        addNode(params, sums, node, pos, vecToCentroid, distance);
+                        continue;
+                    }
+                }
+            }
+
+            if (entry.level == 0 || std::max(cellSize.x, cellSize.y) < params.visionRadius * smallestOpenedNode)
+            {
+                const int leafShift{ entry.level * 2 };
+                openedNodes.push_back({ leafStart[entry.code << leafShift], leafStart[(entry.code + 1) << leafShift] });
+                continue;
+            }
+
+            for (unsigned int child{ 0 }; child < 4; ++child)
+            {
+                const unsigned int childCode{ entry.code * 4 + child };
+                if (levels[entry.level - 1][childCode].count > 0)
+                    stack[stackSize++] = { entry.level - 1, entry.x * 2 + static_cast<int>(child & 1u), entry.y * 2 + static_cast<int>(child >> 1), childCode };
+            }
+        }
+
+        const NeighborSums exact{ kernel::sumRanges(params, pos, velocity, leafData, openedNodes.data(), openedNodes.data() + openedNodes.size()) };
+        sums.separation += exact.separation;
+        sums.alignment += exact.alignment;
+        sums.cohesion += exact.cohesion;
+        sums.hueSin += exact.hueSin;
+        sums.hueCos += exact.hueCos;
+        sums.numVisible += exact.numVisible;
+
+        return sums;
+    }
+}
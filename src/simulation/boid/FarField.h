@@ -0,0 +1,46 @@
+#pragma once
+
+#include "FlockKernel.h"
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+
+// Barnes-Hut style approximation of the neighbor sums for big vision radii, where the 3x3 block of grid cells covers a
+// large part of the screen and the neighbor phase gets close to quadratic again.
+//
+// The boids get binned into a pyramid of grids (64x64 leaf cells, then 32x32 and so on up to 4x4). Every node stores its
+// boid count, the centroid of its boids (worked out relative to the cell so boids that wrapped around don't drag it
+// across the screen), and the sums of its boids' headings and hue vectors. A boid's sums then get built by walking down
+// from the 4x4 level: a node that's completely inside the vision radius and cone and looks small enough from the boid
+// (node size / distance to its centroid under the opening angle) gets added in one go as if all of its boids sat on the
+// centroid, anything else gets opened up, and the boids in opened leaves go through the exact per-pair test.
+//
+// An opening angle of 0 never approximates anything, so it gives the exact sums (up to the order they're added in). At
+// 0.5 and 8x the default vision radius the separation and alignment sums are off by about 0.1-0.2% of the number of
+// visible boids on average and under 1% for any one boid (tests/FarFieldTest.cpp checks that)
+namespace simulation::boid::farfield
+{
+    // How far the approximation is from the exact per-pair sums over a sample of boids. The separation and alignment errors
+    // are relative to the number of visible boids (the most those sums could add up to) and the cohesion error is how far
+    // off the average position is, relative to the vision radius
+    struct ErrorStats
+    {
+        float meanSeparation{ 0.0f };
+        float maxSeparation{ 0.0f };
+        float meanAlignment{ 0.0f };
+        float maxAlignment{ 0.0f };
+        float meanCohesion{ 0.0f };
+        float maxCohesion{ 0.0f };
+        size_t numSampled{ 0 };
+    };
+
+    // Set this to have the next update() measure the error (it needs the grid and kernel::neighborData of that step)
+    extern bool errorMeasurementRequested;
+    extern ErrorStats lastError;
+
+    // Rebuilds the pyramid. Has to be called after kernel::gatherNeighborData()
+    void update(const SimParams& params);
+
+    kernel::NeighborSums sumNeighbors(const SimParams& params, glm::vec2 pos, glm::vec2 velocity);
+}
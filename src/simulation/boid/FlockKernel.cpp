@@ -0,0 +1,990 @@
+#include "FlockKernel.h"
+#include "BoidObject.h"
+#include "BoidParams.h"
+#include "../SimParams.h"
+#include "../ThreadPool.h"
+#include "../FastMath.h"
+
+#include <glm/gtc/constants.hpp>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <type_traits>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64)
+#define BOIDS_X86
+#include <immintrin.h>
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+// Lets a function use instructions past the baseline the rest of the program gets compiled for. Those functions only
+// ever get called after checking the CPU has them (see cpu::getSupportedSimdLevel)
+#define TARGET_ISA(isa) __attribute__((target(isa)))
+#else
+// MSVC lets intrinsics be used anywhere
+#define TARGET_ISA(isa)
+#endif
+
+namespace simulation::boid::kernel
+{
+    NeighborData neighborData{};
+}
+
+namespace
+{
+    // The best the CPU supports unless kernel::setSimdLevel says otherwise
+    simulation::cpu::SimdLevel simdLevel{ simulation::cpu::getSupportedSimdLevel() };
+}
+
+namespace
+{
+    using simulation::boid::kernel::NeighborSums;
+    using simulation::boid::kernel::NeighborData;
+    using simulation::SimParams;
+    using simulation::boid::kernel::neighborData;
+    using simulation::boid::kernel::Range;
+    using simulation::boid::kernel::SumArrays;
+    using simulation::boid::BoidStore;
+    using simulation::cpu::SimdLevel;
+    namespace grid = simulation::boid::grid;
+
+    // The radius and vision cone tests for the scalar paths. k is an index into data. If boid k is visible,
+    // vecToOther and distance are the wrapped vector to it and its length. With FullCone the cone test is left out, and
+    // without Wrap the positions in data are taken to already be the closest copy (see GhostLayer.h)
+    template<bool FullCone, bool Wrap>
+    bool isVisible(const SimParams& params, const NeighborData& data, glm::vec2 pos, glm::vec2 heading, unsigned int k, glm::vec2& vecToOther, float& distance)
+    {
+        vecToOther = glm::vec2{ data.posX[k], data.posY[k] } - pos;
+
+        // Account for wraparound
+        if constexpr (Wrap)
+        {
+            if (std::abs(vecToOther.x) > params.worldSize.x / 2.0f)
+                vecToOther.x -= glm::sign(vecToOther.x) * params.worldSize.x;
+            if (std::abs(vecToOther.y) > params.worldSize.y / 2.0f)
+                vecToOther.y -= glm::sign(vecToOther.y) * params.worldSize.y;
+        }
+
+        // This also skips the boid itself
+        distance = glm::length(vecToOther);
+        if (distance > params.visionRadius || distance < 1e-6) return false;
+
+        if constexpr (FullCone)
+            return true;
+
+        return !(glm::dot(heading, vecToOther / distance) < params.visionAngleCos);
+    }
+
+    void addVisible(const SimParams& params, const NeighborData& data, NeighborSums& sums, glm::vec2 pos, glm::vec2 vecToOther, float distance, unsigned int k)
+    {
+        const glm::vec2 dirToOther{ vecToOther / distance };
+        ++sums.numVisible;
+
+        const float strength{ glm::clamp((params.visionRadius - distance) / params.visionRadius, 0.0f, 1.0f) };
+        sums.separation += -dirToOther * strength;
+
+        sums.alignment += glm::vec2{ data.headingX[k], data.headingY[k] } * strength;
+
+        sums.cohesion += pos + vecToOther; // I'm doing this instead of using the other boid's position to account for wraparound
+
+        sums.hueSin += data.hueSin[k];
+        sums.hueCos += data.hueCos[k];
+    }
+
+    // The deterministic mode's version of NeighborSums. Each pair's terms get rounded to fixed point and summed as integers,
+    // and integer addition gives the same total no matter what order the neighbors come in (grid cells, SIMD lanes,
+    // Morton order, whatever). The unit length terms keep 32 fractional bits and the offsets in pixels 24, so it takes
+    // millions of neighbors to overflow
+    struct FixedPointSums
+    {
+        int64_t separationX{ 0 };
+        int64_t separationY{ 0 };
+        int64_t alignmentX{ 0 };
+        int64_t alignmentY{ 0 };
+        int64_t offsetX{ 0 };
+        int64_t offsetY{ 0 };
+        int64_t hueSin{ 0 };
+        int64_t hueCos{ 0 };
+        int numVisible{ 0 };
+    };
+
+    constexpr double unitScale{ 4294967296.0 };
+    constexpr double pixelScale{ 16777216.0 };
+
+    int64_t toFixed(float value, double scale) { return static_cast<int64_t>(static_cast<double>(value) * scale); }
+    float fromFixed(int64_t value, double scale) { return static_cast<float>(static_cast<double>(value) / scale); }
+
+    // Same terms as the float version, except cohesion sums the offsets to the neighbors instead of their positions so
+    // it fits in the pixel scale wherever the boid is. pos gets added back in by finish()
+    void addVisible(const SimParams& params, const NeighborData& data, FixedPointSums& sums, glm::vec2, glm::vec2 vecToOther, float distance, unsigned int k)
+    {
+        const glm::vec2 dirToOther{ vecToOther / distance };
+        ++sums.numVisible;
+
+        const float strength{ glm::clamp((params.visionRadius - distance) / params.visionRadius, 0.0f, 1.0f) };
+        sums.separationX += toFixed(-dirToOther.x * strength, unitScale);
+        sums.separationY += toFixed(-dirToOther.y * strength, unitScale);
+        sums.alignmentX += toFixed(data.headingX[k] * strength, unitScale);
+        sums.alignmentY += toFixed(data.headingY[k] * strength, unitScale);
+        sums.offsetX += toFixed(vecToOther.x, pixelScale);
+        sums.offsetY += toFixed(vecToOther.y, pixelScale);
+        sums.hueSin += toFixed(data.hueSin[k], unitScale);
+        sums.hueCos += toFixed(data.hueCos[k], unitScale);
+    }
+
+    NeighborSums finish(const NeighborSums& sums, glm::vec2) { return sums; }
+
+    NeighborSums finish(const FixedPointSums& fixed, glm::vec2 pos)
+    {
+        NeighborSums sums{};
+        sums.separation = { fromFixed(fixed.separationX, unitScale), fromFixed(fixed.separationY, unitScale) };
+        sums.alignment = { fromFixed(fixed.alignmentX, unitScale), fromFixed(fixed.alignmentY, unitScale) };
+        sums.cohesion = pos * static_cast<float>(fixed.numVisible) + glm::vec2{ fromFixed(fixed.offsetX, pixelScale), fromFixed(fixed.offsetY, pixelScale) };
+        sums.hueSin = fromFixed(fixed.hueSin, unitScale);
+        sums.hueCos = fromFixed(fixed.hueCos, unitScale);
+        sums.numVisible = fixed.numVisible;
+        return sums;
+    }
+
+    template<bool FullCone, bool Wrap, typename Sums>
+    void addIfVisible(const SimParams& params, const NeighborData& data, Sums& sums, glm::vec2 pos, glm::vec2 heading, unsigned int k)
+    {
+        glm::vec2 vecToOther;
+        float distance;
+        if (isVisible<FullCone, Wrap>(params, data, pos, heading, k, vecToOther, distance))
+            addVisible(params, data, sums, pos, vecToOther, distance, k);
+    }
+
+    struct NearbyBoid
+    {
+        float distance{ 0.0f };
+        glm::vec2 vecToOther{ 0.0f };
+        unsigned int k{ 0 };
+    };
+
+    // Keeps the count closest visible boids in a max-heap on distance, so a candidate costs one compare once the heap is
+    // full and O(log count) if it's closer than the furthest one kept. forEachCandidate(add) calls add(k) for every candidate
+    // (an index into data). Ties on distance go by offset, so which boids make the cut doesn't depend on the order they
+    // come in unless two are in exactly the same place
+    template<bool FullCone, bool Wrap, typename Sums = NeighborSums, typename ForEachCandidate>
+    NeighborSums sumNearest(const SimParams& params, const NeighborData& data, glm::vec2 pos, glm::vec2 velocity, int count, const ForEachCandidate& forEachCandidate)
+    {
+        const glm::vec2 heading{ glm::normalize(velocity) };
+        count = std::clamp(count, 1, simulation::boid::kernel::maxTopologicalNeighbors);
+
+        std::array<NearbyBoid, simulation::boid::kernel::maxTopologicalNeighbors> nearest;
+        const auto heapBegin{ nearest.begin() };
+        int size{ 0 };
+        const auto closer{ [](const NearbyBoid& a, const NearbyBoid& b)
+        {
+            if (a.distance != b.distance)
+                return a.distance < b.distance;
+
+            return a.vecToOther.x != b.vecToOther.x ? a.vecToOther.x < b.vecToOther.x : a.vecToOther.y < b.vecToOther.y;
+        } };
+
+        forEachCandidate([&](unsigned int k)
+        {
+            NearbyBoid boid{};
+            boid.k = k;
+            if (!isVisible<FullCone, Wrap>(params, data, pos, heading, k, boid.vecToOther, boid.distance))
+                return;
+
+            if (size < count)
+            {
+                nearest[size++] = boid;
+                std::push_heap(heapBegin, heapBegin + size, closer);
+                return;
+            }
+
+            if (!closer(boid, nearest[0]))
+                return;
+
+            std::pop_heap(heapBegin, heapBegin + size, closer);
+            nearest[size - 1] = boid;
+            std::push_heap(heapBegin, heapBegin + size, closer);
+        });
+
+        Sums sums{};
+        for (int i{ 0 }; i < size; ++i)
+            addVisible(params, data, sums, pos, nearest[i].vecToOther, nearest[i].distance, nearest[i].k);
+
+        return finish(sums, pos);
+    }
+
+#if defined(BOIDS_X86)
+    TARGET_ISA("avx2") float reduce(__m256 v)
+    {
+        const __m128 sum4{ _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1)) };
+        const __m128 sum2{ _mm_add_ps(sum4, _mm_movehl_ps(sum4, sum4)) };
+        return _mm_cvtss_f32(_mm_add_ss(sum2, _mm_shuffle_ps(sum2, sum2, 1)));
+    }
+
+    // Adds the two halves and finishes with the AVX2 one, which is the same order _mm512_reduce_add_ps adds in.
+    //
+    // GCC 12's unmasked AVX-512 intrinsics (including the casts and _mm512_reduce_add_ps) fill the lanes they don't write
+    // from a self-initialized _mm512_undefined_ps, which trips -Wuninitialized in every function they get inlined into.
+    // The zero masked versions don't, so the AVX-512 kernel only uses those for anything that isn't a plain arithmetic op.
+    // The halves go through a double cast since _mm512_extractf32x8_ps needs AVX-512DQ
+    TARGET_ISA("avx512f") float reduce(__m512 v)
+    {
+        const __m512d halves{ _mm512_castps_pd(v) };
+        const __m256 lower{ _mm256_castpd_ps(_mm512_maskz_extractf64x4_pd(0xF, halves, 0)) };
+        const __m256 upper{ _mm256_castpd_ps(_mm512_maskz_extractf64x4_pd(0xF, halves, 1)) };
+        return reduce(_mm256_add_ps(lower, upper));
+    }
+
+    template<bool FullCone, bool Wrap>
+    TARGET_ISA("avx512f,popcnt") NeighborSums sumAvx512(const SimParams& params, glm::vec2 pos, glm::vec2 velocity, const NeighborData& data, const Range* rangesBegin, const Range* rangesEnd)
+    {
+        const glm::vec2 heading{ glm::normalize(velocity) };
+
+        const __m512 px{ _mm512_set1_ps(pos.x) };
+        const __m512 py{ _mm512_set1_ps(pos.y) };
+        const __m512 hx{ _mm512_set1_ps(heading.x) };
+        const __m512 hy{ _mm512_set1_ps(heading.y) };
+        const __m512 width{ _mm512_set1_ps(params.worldSize.x) };
+        const __m512 height{ _mm512_set1_ps(params.worldSize.y) };
+        const __m512 halfWidth{ _mm512_set1_ps(params.worldSize.x / 2.0f) };
+        const __m512 halfHeight{ _mm512_set1_ps(params.worldSize.y / 2.0f) };
+        const __m512 radius{ _mm512_set1_ps(params.visionRadius) };
+        const __m512 minDistance{ _mm512_set1_ps(1e-6f) };
+        const __m512 visionAngleCos{ _mm512_set1_ps(params.visionAngleCos) };
+        const __m512 zero{ _mm512_setzero_ps() };
+        const __m512 one{ _mm512_set1_ps(1.0f) };
+
+        __m512 separationX{ zero }, separationY{ zero };
+        __m512 alignmentX{ zero }, alignmentY{ zero };
+        __m512 cohesionX{ zero }, cohesionY{ zero };
+        __m512 hueSin{ zero }, hueCos{ zero };
+        int numVisible{ 0 };
+
+        for (const Range* range{ rangesBegin }; range != rangesEnd; ++range)
+        {
+            const unsigned int end{ range->end };
+            for (unsigned int k{ range->begin }; k < end; k += 16)
+            {
+                const __mmask16 inRange{ static_cast<__mmask16>(end - k >= 16 ? 0xFFFF : (1u << (end - k)) - 1) };
+
+                __m512 dx{ _mm512_sub_ps(_mm512_maskz_loadu_ps(inRange, data.posX.data() + k), px) };
+                __m512 dy{ _mm512_sub_ps(_mm512_maskz_loadu_ps(inRange, data.posY.data() + k), py) };
+
+                // Wraparound: subtract the screen size (with dx's sign) from the lanes that are more than half a screen away
+                if constexpr (Wrap)
+                {
+                    dx = _mm512_mask_sub_ps(dx, _mm512_cmp_ps_mask(_mm512_abs_ps(dx), halfWidth, _CMP_GT_OQ), dx,
+                                            _mm512_castsi512_ps(_mm512_or_si512(_mm512_castps_si512(width), _mm512_and_si512(_mm512_castps_si512(dx), _mm512_set1_epi32(0x80000000)))));
+                    dy = _mm512_mask_sub_ps(dy, _mm512_cmp_ps_mask(_mm512_abs_ps(dy), halfHeight, _CMP_GT_OQ), dy,
+                                            _mm512_castsi512_ps(_mm512_or_si512(_mm512_castps_si512(height), _mm512_and_si512(_mm512_castps_si512(dy), _mm512_set1_epi32(0x80000000)))));
+                }
+
+                const __m512 distance{ _mm512_maskz_sqrt_ps(inRange, _mm512_add_ps(_mm512_mul_ps(dx, dx), _mm512_mul_ps(dy, dy))) };
+                __mmask16 visible{ static_cast<__mmask16>(inRange
+                    & _mm512_cmp_ps_mask(distance, radius, _CMP_NGT_UQ)
+                    & _mm512_cmp_ps_mask(distance, minDistance, _CMP_NLT_UQ)) };
+                if (!visible)
+                    continue;
+
+                const __m512 inverseDistance{ _mm512_maskz_div_ps(visible, one, distance) };
+                const __m512 dirX{ _mm512_mul_ps(dx, inverseDistance) };
+                const __m512 dirY{ _mm512_mul_ps(dy, inverseDistance) };
+                if constexpr (!FullCone)
+                {
+                    visible &= _mm512_cmp_ps_mask(_mm512_add_ps(_mm512_mul_ps(hx, dirX), _mm512_mul_ps(hy, dirY)), visionAngleCos, _CMP_NLT_UQ);
+                    if (!visible)
+                        continue;
+                }
+
+                numVisible += std::popcount(static_cast<unsigned int>(visible));
+
+                const __m512 strength{ _mm512_maskz_min_ps(visible, _mm512_maskz_max_ps(visible, _mm512_div_ps(_mm512_sub_ps(radius, distance), radius), zero), one) };
+                separationX = _mm512_mask_sub_ps(separationX, visible, separationX, _mm512_mul_ps(dirX, strength));
+                separationY = _mm512_mask_sub_ps(separationY, visible, separationY, _mm512_mul_ps(dirY, strength));
+                alignmentX = _mm512_mask_add_ps(alignmentX, visible, alignmentX, _mm512_mul_ps(_mm512_maskz_loadu_ps(visible, data.headingX.data() + k), strength));
+                alignmentY = _mm512_mask_add_ps(alignmentY, visible, alignmentY, _mm512_mul_ps(_mm512_maskz_loadu_ps(visible, data.headingY.data() + k), strength));
+                cohesionX = _mm512_mask_add_ps(cohesionX, visible, cohesionX, _mm512_add_ps(px, dx));
+                cohesionY = _mm512_mask_add_ps(cohesionY, visible, cohesionY, _mm512_add_ps(py, dy));
+                hueSin = _mm512_mask_add_ps(hueSin, visible, hueSin, _mm512_maskz_loadu_ps(visible, data.hueSin.data() + k));
+                hueCos = _mm512_mask_add_ps(hueCos, visible, hueCos, _mm512_maskz_loadu_ps(visible, data.hueCos.data() + k));
+            }
+        }
+
+        NeighborSums sums{};
+        sums.separation = { reduce(separationX), reduce(separationY) };
+        sums.alignment = { reduce(alignmentX), reduce(alignmentY) };
+        sums.cohesion = { reduce(cohesionX), reduce(cohesionY) };
+        sums.hueSin = reduce(hueSin);
+        sums.hueCos = reduce(hueCos);
+        sums.numVisible = numVisible;
+        return sums;
+    }
+
+    template<bool FullCone, bool Wrap>
+    TARGET_ISA("avx2,popcnt") NeighborSums sumAvx2(const SimParams& params, glm::vec2 pos, glm::vec2 velocity, const NeighborData& data, const Range* rangesBegin, const Range* rangesEnd)
+    {
+        const glm::vec2 heading{ glm::normalize(velocity) };
+
+        const __m256 px{ _mm256_set1_ps(pos.x) };
+        const __m256 py{ _mm256_set1_ps(pos.y) };
+        const __m256 hx{ _mm256_set1_ps(heading.x) };
+        const __m256 hy{ _mm256_set1_ps(heading.y) };
+        const __m256 width{ _mm256_set1_ps(params.worldSize.x) };
+        const __m256 height{ _mm256_set1_ps(params.worldSize.y) };
+        const __m256 halfWidth{ _mm256_set1_ps(params.worldSize.x / 2.0f) };
+        const __m256 halfHeight{ _mm256_set1_ps(params.worldSize.y / 2.0f) };
+        const __m256 radius{ _mm256_set1_ps(params.visionRadius) };
+        const __m256 minDistance{ _mm256_set1_ps(1e-6f) };
+        const __m256 visionAngleCos{ _mm256_set1_ps(params.visionAngleCos) };
+        const __m256 signBit{ _mm256_set1_ps(-0.0f) };
+        const __m256 zero{ _mm256_setzero_ps() };
+        const __m256 one{ _mm256_set1_ps(1.0f) };
+        const __m256i laneIndex{ _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7) };
+
+        __m256 separationX{ zero }, separationY{ zero };
+        __m256 alignmentX{ zero }, alignmentY{ zero };
+        __m256 cohesionX{ zero }, cohesionY{ zero };
+        __m256 hueSin{ zero }, hueCos{ zero };
+        int numVisible{ 0 };
+
+        for (const Range* range{ rangesBegin }; range != rangesEnd; ++range)
+        {
+            const unsigned int end{ range->end };
+            for (unsigned int k{ range->begin }; k < end; k += 8)
+            {
+                const __m256i inRange{ _mm256_cmpgt_epi32(_mm256_set1_epi32(static_cast<int>(end - k)), laneIndex) };
+
+                __m256 dx{ _mm256_sub_ps(_mm256_maskload_ps(data.posX.data() + k, inRange), px) };
+                __m256 dy{ _mm256_sub_ps(_mm256_maskload_ps(data.posY.data() + k, inRange), py) };
+
+                // Wraparound: subtract the screen size (with dx's sign) from the lanes that are more than half a screen away
+                if constexpr (Wrap)
+                {
+                    const __m256 wrapX{ _mm256_cmp_ps(_mm256_andnot_ps(signBit, dx), halfWidth, _CMP_GT_OQ) };
+                    const __m256 wrapY{ _mm256_cmp_ps(_mm256_andnot_ps(signBit, dy), halfHeight, _CMP_GT_OQ) };
+                    dx = _mm256_sub_ps(dx, _mm256_and_ps(wrapX, _mm256_or_ps(width, _mm256_and_ps(signBit, dx))));
+                    dy = _mm256_sub_ps(dy, _mm256_and_ps(wrapY, _mm256_or_ps(height, _mm256_and_ps(signBit, dy))));
+                }
+
+                const __m256 distance{ _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy))) };
+                __m256 visible{ _mm256_and_ps(_mm256_castsi256_ps(inRange), _mm256_and_ps(
+                    _mm256_cmp_ps(distance, radius, _CMP_NGT_UQ),
+                    _mm256_cmp_ps(distance, minDistance, _CMP_NLT_UQ))) };
+                if (_mm256_testz_ps(visible, visible))
+                    continue;
+
+                const __m256 inverseDistance{ _mm256_div_ps(one, distance) };
+                const __m256 dirX{ _mm256_mul_ps(dx, inverseDistance) };
+                const __m256 dirY{ _mm256_mul_ps(dy, inverseDistance) };
+                if constexpr (!FullCone)
+                    visible = _mm256_and_ps(visible, _mm256_cmp_ps(_mm256_add_ps(_mm256_mul_ps(hx, dirX), _mm256_mul_ps(hy, dirY)), visionAngleCos, _CMP_NLT_UQ));
+                const int visibleBits{ _mm256_movemask_ps(visible) };
+                if (!visibleBits)
+                    continue;
+
+                numVisible += std::popcount(static_cast<unsigned int>(visibleBits));
+
+                const __m256 strength{ _mm256_min_ps(_mm256_max_ps(_mm256_div_ps(_mm256_sub_ps(radius, distance), radius), zero), one) };
+                separationX = _mm256_sub_ps(separationX, _mm256_and_ps(visible, _mm256_mul_ps(dirX, strength)));
+                separationY = _mm256_sub_ps(separationY, _mm256_and_ps(visible, _mm256_mul_ps(dirY, strength)));
+                alignmentX = _mm256_add_ps(alignmentX, _mm256_and_ps(visible, _mm256_mul_ps(_mm256_maskload_ps(data.headingX.data() + k, inRange), strength)));
+                alignmentY = _mm256_add_ps(alignmentY, _mm256_and_ps(visible, _mm256_mul_ps(_mm256_maskload_ps(data.headingY.data() + k, inRange), strength)));
+                cohesionX = _mm256_add_ps(cohesionX, _mm256_and_ps(visible, _mm256_add_ps(px, dx)));
+                cohesionY = _mm256_add_ps(cohesionY, _mm256_and_ps(visible, _mm256_add_ps(py, dy)));
+                hueSin = _mm256_add_ps(hueSin, _mm256_and_ps(visible, _mm256_maskload_ps(data.hueSin.data() + k, inRange)));
+                hueCos = _mm256_add_ps(hueCos, _mm256_and_ps(visible, _mm256_maskload_ps(data.hueCos.data() + k, inRange)));
+            }
+        }
+
+        NeighborSums sums{};
+        sums.separation = { reduce(separationX), reduce(separationY) };
+        sums.alignment = { reduce(alignmentX), reduce(alignmentY) };
+        sums.cohesion = { reduce(cohesionX), reduce(cohesionY) };
+        sums.hueSin = reduce(hueSin);
+        sums.hueCos = reduce(hueCos);
+        sums.numVisible = numVisible;
+        return sums;
+    }
+
+    TARGET_ISA("sse4.2") float reduce(__m128 v)
+    {
+        const __m128 sum2{ _mm_add_ps(v, _mm_movehl_ps(v, v)) };
+        return _mm_cvtss_f32(_mm_add_ss(sum2, _mm_shuffle_ps(sum2, sum2, 1)));
+    }
+
+    // SSE doesn't have masked loads, so the last few entries of a range get copied out instead of reading past the end
+    TARGET_ISA("sse4.2") __m128 loadUpTo4(const float* values, unsigned int count)
+    {
+        if (count >= 4)
+            return _mm_loadu_ps(values);
+
+        std::array<float, 4> tail{};
+        std::copy_n(values, count, tail.data());
+        return _mm_loadu_ps(tail.data());
+    }
+
+    template<bool FullCone, bool Wrap>
+    TARGET_ISA("sse4.2,popcnt") NeighborSums sumSse42(const SimParams& params, glm::vec2 pos, glm::vec2 velocity, const NeighborData& data, const Range* rangesBegin, const Range* rangesEnd)
+    {
+        const glm::vec2 heading{ glm::normalize(velocity) };
+
+        const __m128 px{ _mm_set1_ps(pos.x) };
+        const __m128 py{ _mm_set1_ps(pos.y) };
+        const __m128 hx{ _mm_set1_ps(heading.x) };
+        const __m128 hy{ _mm_set1_ps(heading.y) };
+        const __m128 width{ _mm_set1_ps(params.worldSize.x) };
+        const __m128 height{ _mm_set1_ps(params.worldSize.y) };
+        const __m128 halfWidth{ _mm_set1_ps(params.worldSize.x / 2.0f) };
+        const __m128 halfHeight{ _mm_set1_ps(params.worldSize.y / 2.0f) };
+        const __m128 radius{ _mm_set1_ps(params.visionRadius) };
+        const __m128 minDistance{ _mm_set1_ps(1e-6f) };
+        const __m128 visionAngleCos{ _mm_set1_ps(params.visionAngleCos) };
+        const __m128 signBit{ _mm_set1_ps(-0.0f) };
+        const __m128 zero{ _mm_setzero_ps() };
+        const __m128 one{ _mm_set1_ps(1.0f) };
+        const __m128i laneIndex{ _mm_setr_epi32(0, 1, 2, 3) };
+
+        __m128 separationX{ zero }, separationY{ zero };
+        __m128 alignmentX{ zero }, alignmentY{ zero };
+        __m128 cohesionX{ zero }, cohesionY{ zero };
+        __m128 hueSin{ zero }, hueCos{ zero };
+        int numVisible{ 0 };
+
+        for (const Range* range{ rangesBegin }; range != rangesEnd; ++range)
+        {
+            const unsigned int end{ range->end };
+            for (unsigned int k{ range->begin }; k < end; k += 4)
+            {
+                const unsigned int count{ end - k };
+                const __m128 inRange{ _mm_castsi128_ps(_mm_cmpgt_epi32(_mm_set1_epi32(static_cast<int>(count)), laneIndex)) };
+
+                __m128 dx{ _mm_sub_ps(loadUpTo4(data.posX.data() + k, count), px) };
+                __m128 dy{ _mm_sub_ps(loadUpTo4(data.posY.data() + k, count), py) };
+
+                // Wraparound: subtract the screen size (with dx's sign) from the lanes that are more than half a screen away
+                if constexpr (Wrap)
+                {
+                    const __m128 wrapX{ _mm_cmpgt_ps(_mm_andnot_ps(signBit, dx), halfWidth) };
+                    const __m128 wrapY{ _mm_cmpgt_ps(_mm_andnot_ps(signBit, dy), halfHeight) };
+                    dx = _mm_sub_ps(dx, _mm_and_ps(wrapX, _mm_or_ps(width, _mm_and_ps(signBit, dx))));
+                    dy = _mm_sub_ps(dy, _mm_and_ps(wrapY, _mm_or_ps(height, _mm_and_ps(signBit, dy))));
+                }
+
+                const __m128 distance{ _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy))) };
+                __m128 visible{ _mm_and_ps(inRange, _mm_and_ps(_mm_cmpngt_ps(distance, radius), _mm_cmpnlt_ps(distance, minDistance))) };
+                if (_mm_movemask_ps(visible) == 0)
+                    continue;
+
+                const __m128 inverseDistance{ _mm_div_ps(one, distance) };
+                const __m128 dirX{ _mm_mul_ps(dx, inverseDistance) };
+                const __m128 dirY{ _mm_mul_ps(dy, inverseDistance) };
+                if constexpr (!FullCone)
+                    visible = _mm_and_ps(visible, _mm_cmpnlt_ps(_mm_add_ps(_mm_mul_ps(hx, dirX), _mm_mul_ps(hy, dirY)), visionAngleCos));
+                const int visibleBits{ _mm_movemask_ps(visible) };
+                if (!visibleBits)
+                    continue;
+
+                numVisible += std::popcount(static_cast<unsigned int>(visibleBits));
+
+                const __m128 strength{ _mm_min_ps(_mm_max_ps(_mm_div_ps(_mm_sub_ps(radius, distance), radius), zero), one) };
+                separationX = _mm_sub_ps(separationX, _mm_and_ps(visible, _mm_mul_ps(dirX, strength)));
+                separationY = _mm_sub_ps(separationY, _mm_and_ps(visible, _mm_mul_ps(dirY, strength)));
+                alignmentX = _mm_add_ps(alignmentX, _mm_and_ps(visible, _mm_mul_ps(loadUpTo4(data.headingX.data() + k, count), strength)));
+                alignmentY = _mm_add_ps(alignmentY, _mm_and_ps(visible, _mm_mul_ps(loadUpTo4(data.headingY.data() + k, count), strength)));
+                cohesionX = _mm_add_ps(cohesionX, _mm_and_ps(visible, _mm_add_ps(px, dx)));
+                cohesionY = _mm_add_ps(cohesionY, _mm_and_ps(visible, _mm_add_ps(py, dy)));
+                hueSin = _mm_add_ps(hueSin, _mm_and_ps(visible, loadUpTo4(data.hueSin.data() + k, count)));
+                hueCos = _mm_add_ps(hueCos, _mm_and_ps(visible, loadUpTo4(data.hueCos.data() + k, count)));
+            }
+        }
+
+        NeighborSums sums{};
+        sums.separation = { reduce(separationX), reduce(separationY) };
+        sums.alignment = { reduce(alignmentX), reduce(alignmentY) };
+        sums.cohesion = { reduce(cohesionX), reduce(cohesionY) };
+        sums.hueSin = reduce(hueSin);
+        sums.hueCos = reduce(hueCos);
+        sums.numVisible = numVisible;
+        return sums;
+    }
+#endif
+
+    template<bool FullCone, bool Wrap, typename Sums = NeighborSums>
+    NeighborSums sumScalar(const SimParams& params, glm::vec2 pos, glm::vec2 velocity, const NeighborData& data, const Range* rangesBegin, const Range* rangesEnd)
+    {
+        const glm::vec2 heading{ glm::normalize(velocity) };
+        Sums sums{};
+
+        for (const Range* range{ rangesBegin }; range != rangesEnd; ++range)
+            for (unsigned int k{ range->begin }; k < range->end; ++k)
+                addIfVisible<FullCone, Wrap>(params, data, sums, pos, heading, k);
+
+        return finish(sums, pos);
+    }
+
+    // Calls func(std::bool_constant<fullCone>{}), so the kernels get compiled without the vision cone test for when the
+    // vision angle is 360 degrees and every boid in the radius passes it anyway
+    template<typename Func>
+    NeighborSums withConeTest(const SimParams& params, const Func& func)
+    {
+        if (params.visionAngleCos <= -1.0f)
+            return func(std::true_type{});
+
+        return func(std::false_type{});
+    }
+
+    template<bool FullCone, bool Wrap>
+    NeighborSums sumWithKernel(const SimParams& params, SimdLevel level, glm::vec2 pos, glm::vec2 velocity, const NeighborData& data, const Range* rangesBegin, const Range* rangesEnd)
+    {
+        switch (level)
+        {
+#if defined(BOIDS_X86)
+            case SimdLevel::avx512 : return sumAvx512<FullCone, Wrap>(params, pos, velocity, data, rangesBegin, rangesEnd);
+            case SimdLevel::avx2 : return sumAvx2<FullCone, Wrap>(params, pos, velocity, data, rangesBegin, rangesEnd);
+            case SimdLevel::sse42 : return sumSse42<FullCone, Wrap>(params, pos, velocity, data, rangesBegin, rangesEnd);
+#endif
+            default : return sumScalar<FullCone, Wrap>(params, pos, velocity, data, rangesBegin, rangesEnd);
+        }
+    }
+
+    template<bool Wrap>
+    NeighborSums sumWithBestKernel(const SimParams& params, glm::vec2 pos, glm::vec2 velocity, const NeighborData& data, const Range* rangesBegin, const Range* rangesEnd)
+    {
+        const SimdLevel level{ params.useSimdKernel ? simdLevel : SimdLevel::scalar };
+        return withConeTest(params, [&](auto fullCone)
+        {
+            return sumWithKernel<decltype(fullCone)::value, Wrap>(params, level, pos, velocity, data, rangesBegin, rangesEnd);
+        });
+    }
+
+    // The symmetric pass's pair loop: entry a against every entry in others, each pair tested once and added to both sides'
+    // sums if they can see each other. a's side stays in registers until the end, the others' sums get loaded, added to and
+    // stored back with masks so the lanes past the end of the run are never touched (another thread can be writing them)
+#if defined(BOIDS_X86)
+    // sum[i] += value[i] in the lanes that are set in mask, without touching the others
+    TARGET_ISA("avx512f") void addMasked(float* sum, __mmask16 mask, __m512 value)
+    {
+        _mm512_mask_storeu_ps(sum, mask, _mm512_add_ps(_mm512_maskz_loadu_ps(mask, sum), value));
+    }
+
+    TARGET_ISA("avx2") void addMasked(float* sum, __m256i mask, __m256 value)
+    {
+        _mm256_maskstore_ps(sum, mask, _mm256_add_ps(_mm256_maskload_ps(sum, mask), value));
+    }
+
+    TARGET_ISA("avx512f,popcnt") void addPairsAvx512(const SimParams& params, unsigned int a, Range others, SumArrays& sums)
+    {
+        const NeighborData& data{ neighborData };
+        const __m512 ax{ _mm512_set1_ps(data.posX[a]) };
+        const __m512 ay{ _mm512_set1_ps(data.posY[a]) };
+        const __m512 ahx{ _mm512_set1_ps(data.headingX[a]) };
+        const __m512 ahy{ _mm512_set1_ps(data.headingY[a]) };
+        const __m512 aHueSin{ _mm512_set1_ps(data.hueSin[a]) };
+        const __m512 aHueCos{ _mm512_set1_ps(data.hueCos[a]) };
+        const __m512 width{ _mm512_set1_ps(params.worldSize.x) };
+        const __m512 height{ _mm512_set1_ps(params.worldSize.y) };
+        const __m512 halfWidth{ _mm512_set1_ps(params.worldSize.x / 2.0f) };
+        const __m512 halfHeight{ _mm512_set1_ps(params.worldSize.y / 2.0f) };
+        const __m512 radius{ _mm512_set1_ps(params.visionRadius) };
+        const __m512 minDistance{ _mm512_set1_ps(1e-6f) };
+        const __m512 visionAngleCos{ _mm512_set1_ps(params.visionAngleCos) };
+        const __m512 zero{ _mm512_setzero_ps() };
+        const __m512 one{ _mm512_set1_ps(1.0f) };
+        const __m512i oneInt{ _mm512_set1_epi32(1) };
+
+        __m512 separationX{ zero }, separationY{ zero };
+        __m512 alignmentX{ zero }, alignmentY{ zero };
+        __m512 cohesionX{ zero }, cohesionY{ zero };
+        __m512 hueSin{ zero }, hueCos{ zero };
+        int numVisible{ 0 };
+
+        for (unsigned int k{ others.begin }; k < others.end; k += 16)
+        {
+            const __mmask16 inRange{ static_cast<__mmask16>(others.end - k >= 16 ? 0xFFFF : (1u << (others.end - k)) - 1) };
+
+            const __m512 bx{ _mm512_maskz_loadu_ps(inRange, data.posX.data() + k) };
+            const __m512 by{ _mm512_maskz_loadu_ps(inRange, data.posY.data() + k) };
+            __m512 dx{ _mm512_sub_ps(bx, ax) };
+            __m512 dy{ _mm512_sub_ps(by, ay) };
+            dx = _mm512_mask_sub_ps(dx, _mm512_cmp_ps_mask(_mm512_abs_ps(dx), halfWidth, _CMP_GT_OQ), dx,
+                                    _mm512_castsi512_ps(_mm512_or_si512(_mm512_castps_si512(width), _mm512_and_si512(_mm512_castps_si512(dx), _mm512_set1_epi32(0x80000000)))));
+            dy = _mm512_mask_sub_ps(dy, _mm512_cmp_ps_mask(_mm512_abs_ps(dy), halfHeight, _CMP_GT_OQ), dy,
+                                    _mm512_castsi512_ps(_mm512_or_si512(_mm512_castps_si512(height), _mm512_and_si512(_mm512_castps_si512(dy), _mm512_set1_epi32(0x80000000)))));
+
+            const __m512 distance{ _mm512_maskz_sqrt_ps(inRange, _mm512_add_ps(_mm512_mul_ps(dx, dx), _mm512_mul_ps(dy, dy))) };
+            const __mmask16 inRadius{ static_cast<__mmask16>(inRange
+                & _mm512_cmp_ps_mask(distance, radius, _CMP_NGT_UQ)
+                & _mm512_cmp_ps_mask(distance, minDistance, _CMP_NLT_UQ)) };
+            if (!inRadius)
+                continue;
+
+            const __m512 inverseDistance{ _mm512_maskz_div_ps(inRadius, one, distance) };
+            const __m512 dirX{ _mm512_mul_ps(dx, inverseDistance) };
+            const __m512 dirY{ _mm512_mul_ps(dy, inverseDistance) };
+            const __m512 strength{ _mm512_maskz_min_ps(inRadius, _mm512_maskz_max_ps(inRadius, _mm512_div_ps(_mm512_sub_ps(radius, distance), radius), zero), one) };
+            const __m512 bhx{ _mm512_maskz_loadu_ps(inRadius, data.headingX.data() + k) };
+            const __m512 bhy{ _mm512_maskz_loadu_ps(inRadius, data.headingY.data() + k) };
+
+            // The geometry is shared, but each boid has its own vision cone. b looks at a along -dir
+            const __mmask16 aSees{ static_cast<__mmask16>(inRadius & _mm512_cmp_ps_mask(_mm512_add_ps(_mm512_mul_ps(ahx, dirX), _mm512_mul_ps(ahy, dirY)), visionAngleCos, _CMP_NLT_UQ)) };
+            const __mmask16 bSees{ static_cast<__mmask16>(inRadius & _mm512_cmp_ps_mask(_mm512_sub_ps(zero, _mm512_add_ps(_mm512_mul_ps(bhx, dirX), _mm512_mul_ps(bhy, dirY))), visionAngleCos, _CMP_NLT_UQ)) };
+
+            if (aSees)
+            {
+                numVisible += std::popcount(static_cast<unsigned int>(aSees));
+                separationX = _mm512_mask_sub_ps(separationX, aSees, separationX, _mm512_mul_ps(dirX, strength));
+                separationY = _mm512_mask_sub_ps(separationY, aSees, separationY, _mm512_mul_ps(dirY, strength));
+                alignmentX = _mm512_mask_add_ps(alignmentX, aSees, alignmentX, _mm512_mul_ps(bhx, strength));
+                alignmentY = _mm512_mask_add_ps(alignmentY, aSees, alignmentY, _mm512_mul_ps(bhy, strength));
+                cohesionX = _mm512_mask_add_ps(cohesionX, aSees, cohesionX, _mm512_add_ps(ax, dx));
+                cohesionY = _mm512_mask_add_ps(cohesionY, aSees, cohesionY, _mm512_add_ps(ay, dy));
+                hueSin = _mm512_mask_add_ps(hueSin, aSees, hueSin, _mm512_maskz_loadu_ps(aSees, data.hueSin.data() + k));
+                hueCos = _mm512_mask_add_ps(hueCos, aSees, hueCos, _mm512_maskz_loadu_ps(aSees, data.hueCos.data() + k));
+            }
+
+            if (bSees)
+            {
+                addMasked(sums.separationX.data() + k, bSees, _mm512_mul_ps(dirX, strength));
+                addMasked(sums.separationY.data() + k, bSees, _mm512_mul_ps(dirY, strength));
+                addMasked(sums.alignmentX.data() + k, bSees, _mm512_mul_ps(ahx, strength));
+                addMasked(sums.alignmentY.data() + k, bSees, _mm512_mul_ps(ahy, strength));
+                addMasked(sums.cohesionX.data() + k, bSees, _mm512_sub_ps(bx, dx));
+                addMasked(sums.cohesionY.data() + k, bSees, _mm512_sub_ps(by, dy));
+                addMasked(sums.hueSin.data() + k, bSees, aHueSin);
+                addMasked(sums.hueCos.data() + k, bSees, aHueCos);
+                int* const count{ sums.numVisible.data() + k };
+                _mm512_mask_storeu_epi32(count, bSees, _mm512_add_epi32(_mm512_maskz_loadu_epi32(bSees, count), oneInt));
+            }
+        }
+
+        sums.separationX[a] += reduce(separationX);
+        sums.separationY[a] += reduce(separationY);
+        sums.alignmentX[a] += reduce(alignmentX);
+        sums.alignmentY[a] += reduce(alignmentY);
+        sums.cohesionX[a] += reduce(cohesionX);
+        sums.cohesionY[a] += reduce(cohesionY);
+        sums.hueSin[a] += reduce(hueSin);
+        sums.hueCos[a] += reduce(hueCos);
+        sums.numVisible[a] += numVisible;
+    }
+
+    TARGET_ISA("avx2,popcnt") void addPairsAvx2(const SimParams& params, unsigned int a, Range others, SumArrays& sums)
+    {
+        const NeighborData& data{ neighborData };
+        const __m256 ax{ _mm256_set1_ps(data.posX[a]) };
+        const __m256 ay{ _mm256_set1_ps(data.posY[a]) };
+        const __m256 ahx{ _mm256_set1_ps(data.headingX[a]) };
+        const __m256 ahy{ _mm256_set1_ps(data.headingY[a]) };
+        const __m256 aHueSin{ _mm256_set1_ps(data.hueSin[a]) };
+        const __m256 aHueCos{ _mm256_set1_ps(data.hueCos[a]) };
+        const __m256 width{ _mm256_set1_ps(params.worldSize.x) };
+        const __m256 height{ _mm256_set1_ps(params.worldSize.y) };
+        const __m256 halfWidth{ _mm256_set1_ps(params.worldSize.x / 2.0f) };
+        const __m256 halfHeight{ _mm256_set1_ps(params.worldSize.y / 2.0f) };
+        const __m256 radius{ _mm256_set1_ps(params.visionRadius) };
+        const __m256 minDistance{ _mm256_set1_ps(1e-6f) };
+        const __m256 visionAngleCos{ _mm256_set1_ps(params.visionAngleCos) };
+        const __m256 signBit{ _mm256_set1_ps(-0.0f) };
+        const __m256 zero{ _mm256_setzero_ps() };
+        const __m256 one{ _mm256_set1_ps(1.0f) };
+        const __m256i laneIndex{ _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7) };
+
+        __m256 separationX{ zero }, separationY{ zero };
+        __m256 alignmentX{ zero }, alignmentY{ zero };
+        __m256 cohesionX{ zero }, cohesionY{ zero };
+        __m256 hueSin{ zero }, hueCos{ zero };
+        int numVisible{ 0 };
+
+        for (unsigned int k{ others.begin }; k < others.end; k += 8)
+        {
+            const __m256i inRange{ _mm256_cmpgt_epi32(_mm256_set1_epi32(static_cast<int>(others.end - k)), laneIndex) };
+
+            const __m256 bx{ _mm256_maskload_ps(data.posX.data() + k, inRange) };
+            const __m256 by{ _mm256_maskload_ps(data.posY.data() + k, inRange) };
+            __m256 dx{ _mm256_sub_ps(bx, ax) };
+            __m256 dy{ _mm256_sub_ps(by, ay) };
+            const __m256 wrapX{ _mm256_cmp_ps(_mm256_andnot_ps(signBit, dx), halfWidth, _CMP_GT_OQ) };
+            const __m256 wrapY{ _mm256_cmp_ps(_mm256_andnot_ps(signBit, dy), halfHeight, _CMP_GT_OQ) };
+            dx = _mm256_sub_ps(dx, _mm256_and_ps(wrapX, _mm256_or_ps(width, _mm256_and_ps(signBit, dx))));
+            dy = _mm256_sub_ps(dy, _mm256_and_ps(wrapY, _mm256_or_ps(height, _mm256_and_ps(signBit, dy))));
+
+            const __m256 distance{ _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy))) };
+            const __m256 inRadius{ _mm256_and_ps(_mm256_castsi256_ps(inRange), _mm256_and_ps(
+                _mm256_cmp_ps(distance, radius, _CMP_NGT_UQ),
+                _mm256_cmp_ps(distance, minDistance, _CMP_NLT_UQ))) };
+            if (_mm256_testz_ps(inRadius, inRadius))
+                continue;
+
+            const __m256 inverseDistance{ _mm256_div_ps(one, distance) };
+            const __m256 dirX{ _mm256_mul_ps(dx, inverseDistance) };
+            const __m256 dirY{ _mm256_mul_ps(dy, inverseDistance) };
+            const __m256 strength{ _mm256_min_ps(_mm256_max_ps(_mm256_div_ps(_mm256_sub_ps(radius, distance), radius), zero), one) };
+            const __m256 bhx{ _mm256_maskload_ps(data.headingX.data() + k, inRange) };
+            const __m256 bhy{ _mm256_maskload_ps(data.headingY.data() + k, inRange) };
+
+            // The geometry is shared, but each boid has its own vision cone. b looks at a along -dir
+            const __m256 aSees{ _mm256_and_ps(inRadius, _mm256_cmp_ps(_mm256_add_ps(_mm256_mul_ps(ahx, dirX), _mm256_mul_ps(ahy, dirY)), visionAngleCos, _CMP_NLT_UQ)) };
+            const __m256 bSees{ _mm256_and_ps(inRadius, _mm256_cmp_ps(_mm256_xor_ps(signBit, _mm256_add_ps(_mm256_mul_ps(bhx, dirX), _mm256_mul_ps(bhy, dirY))), visionAngleCos, _CMP_NLT_UQ)) };
+
+            if (const int aSeesBits{ _mm256_movemask_ps(aSees) })
+            {
+                numVisible += std::popcount(static_cast<unsigned int>(aSeesBits));
+                separationX = _mm256_sub_ps(separationX, _mm256_and_ps(aSees, _mm256_mul_ps(dirX, strength)));
+                separationY = _mm256_sub_ps(separationY, _mm256_and_ps(aSees, _mm256_mul_ps(dirY, strength)));
+                alignmentX = _mm256_add_ps(alignmentX, _mm256_and_ps(aSees, _mm256_mul_ps(bhx, strength)));
+                alignmentY = _mm256_add_ps(alignmentY, _mm256_and_ps(aSees, _mm256_mul_ps(bhy, strength)));
+                cohesionX = _mm256_add_ps(cohesionX, _mm256_and_ps(aSees, _mm256_add_ps(ax, dx)));
+                cohesionY = _mm256_add_ps(cohesionY, _mm256_and_ps(aSees, _mm256_add_ps(ay, dy)));
+                hueSin = _mm256_add_ps(hueSin, _mm256_and_ps(aSees, _mm256_maskload_ps(data.hueSin.data() + k, inRange)));
+                hueCos = _mm256_add_ps(hueCos, _mm256_and_ps(aSees, _mm256_maskload_ps(data.hueCos.data() + k, inRange)));
+            }
+
+            if (!_mm256_testz_ps(bSees, bSees))
+            {
+                const __m256i bMask{ _mm256_castps_si256(bSees) };
+                addMasked(sums.separationX.data() + k, bMask, _mm256_mul_ps(dirX, strength));
+                addMasked(sums.separationY.data() + k, bMask, _mm256_mul_ps(dirY, strength));
+                addMasked(sums.alignmentX.data() + k, bMask, _mm256_mul_ps(ahx, strength));
+                addMasked(sums.alignmentY.data() + k, bMask, _mm256_mul_ps(ahy, strength));
+                addMasked(sums.cohesionX.data() + k, bMask, _mm256_sub_ps(bx, dx));
+                addMasked(sums.cohesionY.data() + k, bMask, _mm256_sub_ps(by, dy));
+                addMasked(sums.hueSin.data() + k, bMask, aHueSin);
+                addMasked(sums.hueCos.data() + k, bMask, aHueCos);
+                // The mask is -1 in the lanes that see a
+                int* const count{ sums.numVisible.data() + k };
+                _mm256_maskstore_epi32(count, bMask, _mm256_sub_epi32(_mm256_maskload_epi32(count, bMask), bMask));
+            }
+        }
+
+        sums.separationX[a] += reduce(separationX);
+        sums.separationY[a] += reduce(separationY);
+        sums.alignmentX[a] += reduce(alignmentX);
+        sums.alignmentY[a] += reduce(alignmentY);
+        sums.cohesionX[a] += reduce(cohesionX);
+        sums.cohesionY[a] += reduce(cohesionY);
+        sums.hueSin[a] += reduce(hueSin);
+        sums.hueCos[a] += reduce(hueCos);
+        sums.numVisible[a] += numVisible;
+    }
+#endif
+
+    void addToSums(SumArrays& sums, unsigned int k, unsigned int other, glm::vec2 pos, glm::vec2 vecToOther, glm::vec2 dirToOther, float strength)
+    {
+        const NeighborData& data{ neighborData };
+        ++sums.numVisible[k];
+        sums.separationX[k] -= dirToOther.x * strength;
+        sums.separationY[k] -= dirToOther.y * strength;
+        sums.alignmentX[k] += data.headingX[other] * strength;
+        sums.alignmentY[k] += data.headingY[other] * strength;
+        // Using the wrapped vector instead of the other boid's position to account for wraparound
+        sums.cohesionX[k] += pos.x + vecToOther.x;
+        sums.cohesionY[k] += pos.y + vecToOther.y;
+        sums.hueSin[k] += data.hueSin[other];
+        sums.hueCos[k] += data.hueCos[other];
+    }
+
+    void addPairsScalar(const SimParams& params, unsigned int a, Range others, SumArrays& sums)
+    {
+        const NeighborData& data{ neighborData };
+        const glm::vec2 posA{ data.posX[a], data.posY[a] };
+        const glm::vec2 headingA{ data.headingX[a], data.headingY[a] };
+
+        for (unsigned int b{ others.begin }; b < others.end; ++b)
+        {
+            const glm::vec2 posB{ data.posX[b], data.posY[b] };
+            glm::vec2 vecToB{ posB - posA };
+
+            // Account for wraparound
+            if (std::abs(vecToB.x) > params.worldSize.x / 2.0f)
+                vecToB.x -= glm::sign(vecToB.x) * params.worldSize.x;
+            if (std::abs(vecToB.y) > params.worldSize.y / 2.0f)
+                vecToB.y -= glm::sign(vecToB.y) * params.worldSize.y;
+
+            const float distance{ glm::length(vecToB) };
+            if (distance > params.visionRadius || distance < 1e-6f)
+                continue;
+
+            const glm::vec2 dirToB{ vecToB / distance };
+            const float strength{ glm::clamp((params.visionRadius - distance) / params.visionRadius, 0.0f, 1.0f) };
+
+            if (!(glm::dot(headingA, dirToB) < params.visionAngleCos))
+                addToSums(sums, a, b, posA, vecToB, dirToB, strength);
+            if (!(glm::dot(glm::vec2{ data.headingX[b], data.headingY[b] }, -dirToB) < params.visionAngleCos))
+                addToSums(sums, b, a, posB, -vecToB, -dirToB, strength);
+        }
+    }
+
+    // The range of neighborData in each of the cells
+    struct CellRanges
+    {
+        std::array<Range, 9> ranges{};
+        int count{ 0 };
+
+        const Range* begin() const { return ranges.data(); }
+        const Range* end() const { return ranges.data() + count; }
+    };
+
+    CellRanges getCellRanges(const grid::NeighborCells& cells)
+    {
+        CellRanges ranges{};
+        for (const int cell : cells)
+            ranges.ranges[ranges.count++] = Range{ grid::cellStart[cell], grid::cellStart[cell + 1] };
+
+        return ranges;
+    }
+}
+
+const char* simulation::boid::kernel::getSimdKernelName()
+{
+    return cpu::getSimdLevelName(simdLevel);
+}
+
+simulation::cpu::SimdLevel simulation::boid::kernel::getSimdLevel()
+{
+    return simdLevel;
+}
+
+simulation::cpu::SimdLevel simulation::boid::kernel::setSimdLevel(cpu::SimdLevel level)
+{
+    simdLevel = std::min(level, cpu::getSupportedSimdLevel());
+    return simdLevel;
+}
+
+void simulation::boid::kernel::gatherNeighborData(const SimParams& params)
+{
+    gatherNeighborData(params, neighborData, grid::sortedIndices);
+}
+
+void simulation::boid::kernel::gatherNeighborData(const SimParams& params, NeighborData& data, const std::vector<unsigned int>& order)
+{
+    const size_t numBoids{ order.size() };
+
+    data.posX.resize(numBoids);
+    data.posY.resize(numBoids);
+    data.headingX.resize(numBoids);
+    data.headingY.resize(numBoids);
+    data.hueCos.resize(numBoids);
+    data.hueSin.resize(numBoids);
+
+    threadPool.parallelFor(numBoids, 1024, [&](size_t begin, size_t end) { gatherNeighborData(params, data, order, begin, end, begin); });
+}
+
+void simulation::boid::kernel::gatherNeighborData(const SimParams& params, NeighborData& data, const std::vector<unsigned int>& order, size_t begin, size_t end, size_t to)
+{
+    const BoidStore& boids{ BoidObject::s_boids };
+    for (size_t k{ begin }; k < end; ++k, ++to)
+    {
+        const unsigned int i{ order[k] };
+        const glm::vec2 pos{ boids.getPos(i) };
+        data.posX[to] = pos.x;
+        data.posY[to] = pos.y;
+
+        const glm::vec2 heading{ fastmath::normalize(params.precision, boids.getVelocity(i)) };
+        data.headingX[to] = heading.x;
+        data.headingY[to] = heading.y;
+
+        // Hue averaging using complex number projection
+        const float hueAngle{ glm::two_pi<float>() * boids.getHue(i) };
+        fastmath::sincos(params.precision, hueAngle, data.hueSin[to], data.hueCos[to]);
+    }
+}
+
+simulation::boid::kernel::NeighborSums simulation::boid::kernel::sumNeighbors(const SimParams& params, glm::vec2 pos, glm::vec2 velocity, const grid::NeighborCells& cells)
+{
+    const CellRanges ranges{ getCellRanges(cells) };
+    return sumWithBestKernel<true>(params, pos, velocity, neighborData, ranges.begin(), ranges.end());
+}
+
+simulation::boid::kernel::NeighborSums simulation::boid::kernel::sumNeighborsScalar(const SimParams& params, glm::vec2 pos, glm::vec2 velocity, const grid::NeighborCells& cells)
+{
+    const CellRanges ranges{ getCellRanges(cells) };
+    return withConeTest(params, [&](auto fullCone) { return sumScalar<decltype(fullCone)::value, true>(params, pos, velocity, neighborData, ranges.begin(), ranges.end()); });
+}
+
+simulation::boid::kernel::NeighborSums simulation::boid::kernel::sumNeighborsDeterministic(const SimParams& params, glm::vec2 pos, glm::vec2 velocity, const grid::NeighborCells& cells)
+{
+    const CellRanges ranges{ getCellRanges(cells) };
+    return withConeTest(params, [&](auto fullCone) { return sumScalar<decltype(fullCone)::value, true, FixedPointSums>(params, pos, velocity, neighborData, ranges.begin(), ranges.end()); });
+}
+
+simulation::boid::kernel::NeighborSums simulation::boid::kernel::sumRanges(const SimParams& params, glm::vec2 pos, glm::vec2 velocity, const NeighborData& data, const Range* rangesBegin, const Range* rangesEnd)
+{
+    return sumWithBestKernel<true>(params, pos, velocity, data, rangesBegin, rangesEnd);
+}
+
+simulation::boid::kernel::NeighborSums simulation::boid::kernel::sumUnwrappedRanges(const SimParams& params, glm::vec2 pos, glm::vec2 velocity, const NeighborData& data, const Range* rangesBegin, const Range* rangesEnd)
+{
+    return sumWithBestKernel<false>(params, pos, velocity, data, rangesBegin, rangesEnd);
+}
+
+void simulation::boid::kernel::SumArrays::reset(size_t numBoids)
+{
+    for (BoidStore::Array<float>* sum : { &separationX, &separationY, &alignmentX, &alignmentY, &cohesionX, &cohesionY, &hueSin, &hueCos })
+        sum->assign(numBoids, 0.0f);
+    numVisible.assign(numBoids, 0);
+}
+
+simulation::boid::kernel::NeighborSums simulation::boid::kernel::SumArrays::get(unsigned int k) const
+{
+    NeighborSums sums{};
+    sums.separation = { separationX[k], separationY[k] };
+    sums.alignment = { alignmentX[k], alignmentY[k] };
+    sums.cohesion = { cohesionX[k], cohesionY[k] };
+    sums.hueSin = hueSin[k];
+    sums.hueCos = hueCos[k];
+    sums.numVisible = numVisible[k];
+    return sums;
+}
+
+void simulation::boid::kernel::addPairs(const SimParams& params, unsigned int a, Range others, SumArrays& sums)
+{
+    // There's no SSE4.2 version, without masked stores the tail of the run would have to be done one boid at a time anyway
+    switch (params.useSimdKernel ? simdLevel : SimdLevel::scalar)
+    {
+#if defined(BOIDS_X86)
+        case SimdLevel::avx512 : addPairsAvx512(params, a, others, sums); return;
+        case SimdLevel::avx2 : addPairsAvx2(params, a, others, sums); return;
+#endif
+        default : addPairsScalar(params, a, others, sums); return;
+    }
+}
+
+simulation::boid::kernel::NeighborSums simulation::boid::kernel::sumNearestNeighbors(const SimParams& params, glm::vec2 pos, glm::vec2 velocity, const grid::NeighborCells& cells, int count)
+{
+    return withConeTest(params, [&](auto fullCone)
+    {
+        return sumNearest<decltype(fullCone)::value, true>(params, neighborData, pos, velocity, count, [&](const auto& add)
+        {
+            for (const int cell : cells)
+                for (unsigned int k{ grid::cellStart[cell] }; k < grid::cellStart[cell + 1]; ++k)
+                    add(k);
+        });
+    });
+}
+
+simulation::boid::kernel::NeighborSums simulation::boid::kernel::sumNearestNeighborsDeterministic(const SimParams& params, glm::vec2 pos, glm::vec2 velocity, const grid::NeighborCells& cells, int count)
+{
+    return withConeTest(params, [&](auto fullCone)
+    {
+        return sumNearest<decltype(fullCone)::value, true, FixedPointSums>(params, neighborData, pos, velocity, count, [&](const auto& add)
+        {
+            for (const int cell : cells)
+                for (unsigned int k{ grid::cellStart[cell] }; k < grid::cellStart[cell + 1]; ++k)
+                    add(k);
+        });
+    });
+}
+
+simulation::boid::kernel::NeighborSums simulation::boid::kernel::sumNearestUnwrappedRanges(const SimParams& params, glm::vec2 pos, glm::vec2 velocity, const NeighborData& data, const Range* rangesBegin, const Range* rangesEnd, int count)
+{
+    return withConeTest(params, [&](auto fullCone)
+    {
+        return sumNearest<decltype(fullCone)::value, false>(params, data, pos, velocity, count, [&](const auto& add)
+        {
+            for (const Range* range{ rangesBegin }; range != rangesEnd; ++range)
+                for (unsigned int k{ range->begin }; k < range->end; ++k)
+                    add(k);
+        });
+    });
+}
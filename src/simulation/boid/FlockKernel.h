@@ -0,0 +1,121 @@
+#pragma once
+
+#include "BoidStore.h"
+#include "SpatialGrid.h"
+#include "../CpuFeatures.h"
+#include "../SimParams.h"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+// The neighbor phase of updateBoids: summing up separation, alignment, cohesion and hue over every boid a boid can see.
+//
+// Before the neighbor phase, gatherNeighborData() copies what the neighbor loop reads into arrays sorted by grid cell
+// (the same order as grid::sortedIndices) so that every cell is one contiguous run that can be loaded straight into
+// SIMD registers. Each boid's heading and hue vector (cos, sin) are computed there once, instead of once per pair.
+//
+// The SIMD kernels (AVX-512: 16 candidates at a time, AVX2: 8, SSE4.2: 4) do the same per-pair math as the scalar kernel
+// with the radius and vision cone tests turned into lane masks and the wraparound done with a masked subtract instead of
+// a branch (or not at all for the ghost padded grid in GhostLayer.h, which already has it baked in). The only difference
+// is the order the sums are added up in, so the results match the scalar path to within float rounding. The error is
+// absolute rather than relative, since the terms of a sum can cancel out: on a clumped 20000 boid flock in a 1920 x 1080
+// world the separation, alignment and hue sums differ by up to 4e-4 and the average neighbor position by 1.5e-3. A
+// neighbor sitting within rounding of the vision radius or cone edge can also land on the other side of the test, which
+// changes numVisible by one (a couple of boids out of the 20000). tests/FlockKernelTest.cpp checks all of this.
+//
+// All of the kernels get compiled into the same binary (each one for its own instruction set), and the best one the CPU
+// supports gets picked at startup
+namespace simulation::boid::kernel
+{
+    struct NeighborSums
+    {
+        glm::vec2 separation{ 0.0f };
+        glm::vec2 alignment{ 0.0f };
+        glm::vec2 cohesion{ 0.0f };
+        float hueSin{ 0.0f };
+        float hueCos{ 0.0f };
+        int numVisible{ 0 };
+    };
+
+    // Boid data in grid cell order. Entry k belongs to the boid grid::sortedIndices[k]
+    struct NeighborData
+    {
+        BoidStore::Array<float> posX{};
+        BoidStore::Array<float> posY{};
+        BoidStore::Array<float> headingX{};
+        BoidStore::Array<float> headingY{};
+        BoidStore::Array<float> hueCos{};
+        BoidStore::Array<float> hueSin{};
+    };
+
+    extern NeighborData neighborData;
+
+    // Largest k the topological (k nearest) mode supports
+    constexpr int maxTopologicalNeighbors{ 32 };
+
+    // Name of the kernel sumNeighbors uses when SIMD is enabled (for the UI)
+    const char* getSimdKernelName();
+
+    cpu::SimdLevel getSimdLevel();
+    // Picks the kernel to use when SIMD is enabled. Levels the CPU doesn't support get lowered to the best one it does,
+    // and the level actually picked gets returned
+    cpu::SimdLevel setSimdLevel(cpu::SimdLevel level);
+
+    // A run of entries [begin, end) in a NeighborData
+    struct Range
+    {
+        unsigned int begin{ 0 };
+        unsigned int end{ 0 };
+    };
+
+    // Has to be called after grid::rebuild()
+    void gatherNeighborData(const SimParams& params);
+    // Fills data in with boid order[k] at entry k
+    void gatherNeighborData(const SimParams& params, NeighborData& data, const std::vector<unsigned int>& order);
+    // Fills entries to up to to + (end - begin) of data in with boids order[begin] up to order[end], on the calling thread.
+    // data has to be big enough already
+    void gatherNeighborData(const SimParams& params, NeighborData& data, const std::vector<unsigned int>& order, size_t begin, size_t end, size_t to);
+
+    NeighborSums sumNeighbors(const SimParams& params, glm::vec2 pos, glm::vec2 velocity, const grid::NeighborCells& cells);
+    NeighborSums sumNeighborsScalar(const SimParams& params, glm::vec2 pos, glm::vec2 velocity, const grid::NeighborCells& cells);
+    // The scalar per-pair test with the sums done in fixed point, so the result comes out bit for bit the same whatever
+    // order the neighbors get visited in (see params.deterministic)
+    NeighborSums sumNeighborsDeterministic(const SimParams& params, glm::vec2 pos, glm::vec2 velocity, const grid::NeighborCells& cells);
+
+    // Same as sumNeighbors, but over runs of entries in any NeighborData instead of the grid's cells
+    NeighborSums sumRanges(const SimParams& params, glm::vec2 pos, glm::vec2 velocity, const NeighborData& data, const Range* rangesBegin, const Range* rangesEnd);
+
+    // Same as sumRanges, but for data that has the wraparound baked into its positions already (see GhostLayer.h), so the
+    // per-pair test skips it. pos has to be on the screen
+    NeighborSums sumUnwrappedRanges(const SimParams& params, glm::vec2 pos, glm::vec2 velocity, const NeighborData& data, const Range* rangesBegin, const Range* rangesEnd);
+
+    // Per-boid sums in NeighborData order with one array per component, so a run of boids' sums can be loaded and stored
+    // the same way as their data. The symmetric pass (SymmetricPass.h) adds into these
+    struct SumArrays
+    {
+        BoidStore::Array<float> separationX{};
+        BoidStore::Array<float> separationY{};
+        BoidStore::Array<float> alignmentX{};
+        BoidStore::Array<float> alignmentY{};
+        BoidStore::Array<float> cohesionX{};
+        BoidStore::Array<float> cohesionY{};
+        BoidStore::Array<float> hueSin{};
+        BoidStore::Array<float> hueCos{};
+        BoidStore::Array<int> numVisible{};
+
+        // Sizes every array to numBoids and zeroes them
+        void reset(size_t numBoids);
+        NeighborSums get(unsigned int k) const;
+    };
+
+    // Tests every pair between entry a of neighborData and the entries in others (which can't include a) once, and adds
+    // each pair to the sums of whichever of the two can see the other. Only the entries a and others get written
+    void addPairs(const SimParams& params, unsigned int a, Range others, SumArrays& sums);
+
+    // Topological versions of the above: only the count closest visible boids get summed, so the work after the scan over
+    // the candidates is capped no matter how many boids are packed into the vision radius
+    NeighborSums sumNearestNeighbors(const SimParams& params, glm::vec2 pos, glm::vec2 velocity, const grid::NeighborCells& cells, int count);
+    NeighborSums sumNearestNeighborsDeterministic(const SimParams& params, glm::vec2 pos, glm::vec2 velocity, const grid::NeighborCells& cells, int count);
+    NeighborSums sumNearestUnwrappedRanges(const SimParams& params, glm::vec2 pos, glm::vec2 velocity, const NeighborData& data, const Range* rangesBegin, const Range* rangesEnd, int count);
+}
@@ -0,0 +1,36 @@
+#include "FlockStats.h"
+#include "FlockKernel.h"
+#include "SpatialGrid.h"
+
+#include <glm/glm.hpp>
+
+#include <cmath>
+
+simulation::boid::flockstats::Stats simulation::boid::flockstats::measure(const SimParams& params)
+{
+    grid::rebuild(params);
+    kernel::gatherNeighborData(params);
+
+    const kernel::NeighborData& data{ kernel::neighborData };
+    const size_t numBoids{ data.posX.size() };
+    if (numBoids == 0)
+        return {};
+
+    // Doubles so that the sums don't lose the small ones with a lot of boids
+    double headingSumX{ 0.0 };
+    double headingSumY{ 0.0 };
+    double neighborSum{ 0.0 };
+    for (size_t k{ 0 }; k < numBoids; ++k)
+    {
+        const glm::vec2 pos{ data.posX[k], data.posY[k] };
+        const glm::vec2 heading{ data.headingX[k], data.headingY[k] };
+        headingSumX += heading.x;
+        headingSumY += heading.y;
+        neighborSum += kernel::sumNeighborsScalar(params, pos, heading, grid::getNeighborCells(pos)).numVisible;
+    }
+
+    Stats stats{};
+    stats.polarization = static_cast<float>(std::sqrt(headingSumX * headingSumX + headingSumY * headingSumY) / static_cast<double>(numBoids));
+    stats.averageNeighbors = static_cast<float>(neighborSum / static_cast<double>(numBoids));
+    return stats;
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "../SimParams.h"
+
+// Summary numbers for how the flock as a whole is behaving, for checking that a change to how the boids are stored or
+// summed (compact state, fast math) doesn't change what the flock does. They're averages over every boid, so they should
+// stay within noise of each other between two runs even when the individual boids end up in different places
+// (tests/FlockStatsTest.cpp checks compact state and fast math against full float storage that way)
+namespace simulation::boid::flockstats
+{
+    struct Stats
+    {
+        // Length of the average heading, 1 when every boid points the same way and around 0 when they're all over the place
+        float polarization{ 0.0f };
+        // How many other boids each boid can see (within the vision radius and cone)
+        float averageNeighbors{ 0.0f };
+    };
+
+    // Measures the flock as it is now. It rebuilds the grid and kernel::neighborData for that (steps with the ghost layer on
+    // don't fill kernel::neighborData in), so it can't be called during a step
+    Stats measure(const SimParams& params);
+}
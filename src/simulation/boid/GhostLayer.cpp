@@ -0,0 +1,205 @@
+#include "GhostLayer.h"
+#include "BoidObject.h"
+#include "../SimParams.h"
+#include "../ThreadPool.h"
+
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+namespace
+{
+    using simulation::boid::kernel::NeighborData;
+    using simulation::SimParams;
+    using simulation::boid::kernel::NeighborSums;
+    using simulation::boid::kernel::Range;
+    using simulation::boid::kernel::neighborData;
+    namespace grid = simulation::boid::grid;
+
+    // Rows of cells per chunk when gathering and copying
+    constexpr size_t rowsPerChunk{ 4 };
+
+    // kernel::neighborData laid out over the padded grid, which takes its place while the ghost layer is on. The boids in
+    // padded cell c are paddedData[paddedStart[c]] up to paddedData[paddedStart[c + 1]]
+    NeighborData paddedData{};
+    std::vector<unsigned int> paddedStart{};
+
+    int getPaddedWidth() { return grid::numCellsX + 2; }
+
+    // Boids can be up to a triangle's height past the edge of the screen before they wrap, and the grid puts those in the
+    // cell on the other side, so their positions have to be brought onto the screen to line up with the ghosts
+    glm::vec2 getWrappedPos(const SimParams& params, glm::vec2 pos)
+    {
+        return { pos.x - std::floor(pos.x / params.worldSize.x) * params.worldSize.x,
+                 pos.y - std::floor(pos.y / params.worldSize.y) * params.worldSize.y };
+    }
+
+    // Which cell a padded column/row copies, and how far its copy gets shifted
+    int getSourceCell(int padded, int numCells) { return (padded - 1 + numCells) % numCells; }
+    float getShift(int padded, int numCells, float screenSize) { return padded == 0 ? -screenSize : padded == numCells + 1 ? screenSize : 0.0f; }
+
+    // The runs of paddedData for the cells around a boid, with runs that touch merged into one
+    struct PaddedRanges
+    {
+        std::array<Range, 9> ranges{};
+        int count{ 0 };
+
+        const Range* begin() const { return ranges.data(); }
+        const Range* end() const { return ranges.data() + count; }
+    };
+
+    // cells are the boid's neighboring cells from the grid (already wrapped). Each one gets mapped back to the copy of it
+    // next to the boid, which is unique as long as the grid is at least 3x3
+    PaddedRanges getPaddedRanges(glm::vec2 pos, const grid::NeighborCells& cells)
+    {
+        const int cell{ grid::getCellIndex(pos) };
+        const int cellX{ cell % grid::numCellsX };
+        const int cellY{ cell / grid::numCellsX };
+        const auto getOffset{ [](int neighbor, int own, int numCells) { return neighbor == own ? 0 : neighbor == (own + 1) % numCells ? 1 : -1; } };
+
+        PaddedRanges ranges{};
+        for (const int neighborCell : cells)
+        {
+            const int paddedX{ cellX + 1 + getOffset(neighborCell % grid::numCellsX, cellX, grid::numCellsX) };
+            const int paddedY{ cellY + 1 + getOffset(neighborCell / grid::numCellsX, cellY, grid::numCellsY) };
+            const int paddedCell{ paddedY * getPaddedWidth() + paddedX };
+
+            const Range range{ paddedStart[paddedCell], paddedStart[paddedCell + 1] };
+            if (range.begin == range.end)
+                continue;
+
+            // The cells come row by row from left to right, so neighbors in a row are next to each other in paddedData
+            if (ranges.count > 0 && ranges.ranges[ranges.count - 1].end == range.begin)
+                ranges.ranges[ranges.count - 1].end = range.end;
+            else
+                ranges.ranges[ranges.count++] = range;
+        }
+
+        return ranges;
+    }
+
+    // The kernels sum up the wrapped position of each visible boid, but the cohesion force is worked out relative to the
+    // boid's actual position
+    NeighborSums shiftCohesion(NeighborSums sums, glm::vec2 shift)
+    {
+        sums.cohesion += shift * static_cast<float>(sums.numVisible);
+        return sums;
+    }
+}
+
+namespace simulation::boid::ghost
+{
+    float rebuildMilliseconds{ 0.0f };
+    size_t numGhosts{ 0 };
+
+    bool isAvailable()
+    {
+        return grid::numCellsX >= 3 && grid::numCellsY >= 3;
+    }
+
+    void rebuild(const SimParams& params)
+    {
+        const auto startTime{ std::chrono::steady_clock::now() };
+
+        const int paddedWidth{ getPaddedWidth() };
+        const int paddedHeight{ grid::numCellsY + 2 };
+        paddedStart.resize(static_cast<size_t>(paddedWidth) * paddedHeight + 1);
+
+        // Every padded cell holds as many boids as the cell it copies
+        paddedStart[0] = 0;
+        for (int y{ 0 }; y < paddedHeight; ++y)
+        {
+            for (int x{ 0 }; x < paddedWidth; ++x)
+            {
+                const int source{ getSourceCell(y, grid::numCellsY) * grid::numCellsX + getSourceCell(x, grid::numCellsX) };
+                const int paddedCell{ y * paddedWidth + x };
+                paddedStart[paddedCell + 1] = paddedStart[paddedCell] + grid::cellStart[source + 1] - grid::cellStart[source];
+            }
+        }
+
+        const size_t numEntries{ paddedStart.back() };
+        paddedData.posX.resize(numEntries);
+        paddedData.posY.resize(numEntries);
+        paddedData.headingX.resize(numEntries);
+        paddedData.headingY.resize(numEntries);
+        paddedData.hueCos.resize(numEntries);
+        paddedData.hueSin.resize(numEntries);
+
+        // The real cells of a row sit in one run between its two ghost cells, in the same order as grid::sortedIndices, so
+        // they get gathered straight into paddedData. Only boids in the outer rows and columns of cells can be off the
+        // screen, so only those cells need their positions wrapped
+        threadPool.parallelFor(grid::numCellsY, rowsPerChunk, [&](size_t begin, size_t end)
+        {
+            for (size_t y{ begin }; y < end; ++y)
+            {
+                const size_t firstCell{ y * grid::numCellsX };
+                kernel::gatherNeighborData(params, paddedData, grid::sortedIndices, grid::cellStart[firstCell], grid::cellStart[firstCell + grid::numCellsX],
+                                           paddedStart[(y + 1) * paddedWidth + 1]);
+
+                const bool outerRow{ y == 0 || y == static_cast<size_t>(grid::numCellsY) - 1 };
+                for (int x{ 0 }; x < grid::numCellsX; x += outerRow ? 1 : grid::numCellsX - 1)
+                {
+                    const int paddedCell{ static_cast<int>(y + 1) * paddedWidth + x + 1 };
+                    for (unsigned int k{ paddedStart[paddedCell] }; k < paddedStart[paddedCell + 1]; ++k)
+                    {
+                        const glm::vec2 pos{ getWrappedPos(params, glm::vec2{ paddedData.posX[k], paddedData.posY[k] }) };
+                        paddedData.posX[k] = pos.x;
+                        paddedData.posY[k] = pos.y;
+                    }
+                }
+            }
+        });
+
+        // Then each ghost cell in the ring copies the real cell it stands in for
+        threadPool.parallelFor(paddedHeight, rowsPerChunk, [&](size_t begin, size_t end)
+        {
+            for (size_t y{ begin }; y < end; ++y)
+            {
+                const int sourceRow{ getSourceCell(static_cast<int>(y), grid::numCellsY) };
+                const float shiftY{ getShift(static_cast<int>(y), grid::numCellsY, params.worldSize.y) };
+
+                const bool ghostRow{ y == 0 || y == static_cast<size_t>(paddedHeight) - 1 };
+                for (int x{ 0 }; x < paddedWidth; x += ghostRow ? 1 : paddedWidth - 1)
+                {
+                    const int source{ (sourceRow + 1) * paddedWidth + getSourceCell(x, grid::numCellsX) + 1 };
+                    const glm::vec2 shift{ getShift(x, grid::numCellsX, params.worldSize.x), shiftY };
+
+                    unsigned int to{ paddedStart[y * paddedWidth + x] };
+                    for (unsigned int from{ paddedStart[source] }; from < paddedStart[source + 1]; ++from, ++to)
+                    {
+                        paddedData.posX[to] = paddedData.posX[from] + shift.x;
+                        paddedData.posY[to] = paddedData.posY[from] + shift.y;
+                        paddedData.headingX[to] = paddedData.headingX[from];
+                        paddedData.headingY[to] = paddedData.headingY[from];
+                        paddedData.hueCos[to] = paddedData.hueCos[from];
+                        paddedData.hueSin[to] = paddedData.hueSin[from];
+                    }
+                }
+            }
+        });
+
+        numGhosts = numEntries - BoidObject::s_boids.size();
+        rebuildMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+    }
+
+    kernel::NeighborSums sumNeighbors(const SimParams& params, glm::vec2 pos, glm::vec2 velocity, const grid::NeighborCells& cells)
+    {
+        const glm::vec2 wrappedPos{ getWrappedPos(params, pos) };
+        const PaddedRanges ranges{ getPaddedRanges(pos, cells) };
+        return shiftCohesion(kernel::sumUnwrappedRanges(params, wrappedPos, velocity, paddedData, ranges.begin(), ranges.end()), pos - wrappedPos);
+    }
+
+    kernel::NeighborSums sumNearestNeighbors(const SimParams& params, glm::vec2 pos, glm::vec2 velocity, const grid::NeighborCells& cells, int count)
+    {
+        const glm::vec2 wrappedPos{ getWrappedPos(params, pos) };
+        const PaddedRanges ranges{ getPaddedRanges(pos, cells) };
+        return shiftCohesion(kernel::sumNearestUnwrappedRanges(params, wrappedPos, velocity, paddedData, ranges.begin(), ranges.end(), count), pos - wrappedPos);
+    }
+
+    size_t getMemoryUsage()
+    {
+        constexpr size_t floatsPerEntry{ 6 };
+        return numGhosts * floatsPerEntry * sizeof(float) + paddedStart.capacity() * sizeof(unsigned int);
+    }
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "FlockKernel.h"
+#include "SpatialGrid.h"
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+
+// Handles the wraparound for the grid path once per step instead of once per pair. The grid gets padded with a ring of
+// ghost cells: the column left of column 0 is a copy of the last column with its positions shifted left by a screen width,
+// and so on for the other three sides and the four corners. A boid in any cell then finds the right copy of everything
+// within its vision radius in the 3x3 block around it in the padded grid, so the neighbor kernel can work on plain
+// vectors without checking whether each one should wrap.
+//
+// The padded grid keeps the layout of kernel::neighborData (sorted by cell, row by row), so a row of the 3x3 block is
+// one contiguous run and a boid's whole neighborhood is three ranges instead of nine.
+//
+// Only the grid search reads the padded grid. The symmetric pass and the far-field approximation still wrap per pair
+namespace simulation::boid::ghost
+{
+    // For the UI
+    extern float rebuildMilliseconds;
+    extern size_t numGhosts;
+
+    // With less than 3 cells across, a cell and its ghost can both be in the same 3x3 block
+    bool isAvailable();
+
+    // Has to be called after grid::rebuild(). Gathers the boids into the padded grid itself, in place of
+    // kernel::gatherNeighborData(), so kernel::neighborData doesn't get filled in for steps that use the ghost layer
+    void rebuild(const SimParams& params);
+
+    kernel::NeighborSums sumNeighbors(const SimParams& params, glm::vec2 pos, glm::vec2 velocity, const grid::NeighborCells& cells);
+    kernel::NeighborSums sumNearestNeighbors(const SimParams& params, glm::vec2 pos, glm::vec2 velocity, const grid::NeighborCells& cells, int count);
+
+    // Bytes the ghost layer adds on top of the boids' own entries: the copies in the ring and the padded cell starts
+    size_t getMemoryUsage();
+}
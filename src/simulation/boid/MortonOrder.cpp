@@ -0,0 +1,182 @@
+#include "MortonOrder.h"
+#include "BoidObject.h"
+#include "SpatialGrid.h"
+#include "../SimParams.h"
+#include "../ThreadPool.h"
+#include "../FrameArena.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <vector>
+
+namespace
+{
+    // Below this many boids it's not worth splitting the sort up between threads
+    constexpr size_t parallelSortThreshold{ 1 << 16 };
+    constexpr size_t maxSortChunks{ 16 };
+
+    // Reorder early if locality has fallen this far below what it was right after the last reorder
+    constexpr float localityDropFactor{ 0.8f };
+
+    std::vector<uint32_t> keys{};
+    std::vector<uint32_t> indices{};
+    std::vector<uint32_t> keysScratch{};
+    std::vector<uint32_t> indicesScratch{};
+
+    // Spreads the lower 16 bits of x out so there's a zero between each of them
+    uint32_t spreadBits(uint32_t x)
+    {
+        x &= 0x0000FFFF;
+        x = (x | (x << 8)) & 0x00FF00FF;
+        x = (x | (x << 4)) & 0x0F0F0F0F;
+        x = (x | (x << 2)) & 0x33333333;
+        x = (x | (x << 1)) & 0x55555555;
+        return x;
+    }
+
+    // Quantizes a (wrapped) coordinate to 16 bits
+    uint32_t quantize(float value, float extent)
+    {
+        float wrapped{ std::fmod(value, extent) };
+        if (wrapped < 0.0f)
+            wrapped += extent;
+
+        return std::min(static_cast<uint32_t>(wrapped / extent * 65536.0f), 65535u);
+    }
+
+    // Runs func(chunk) for every chunk on the simulation thread pool
+    template<typename Func>
+    void runChunks(size_t numChunks, const Func& func)
+    {
+        simulation::threadPool.parallelFor(numChunks, 1, [&](size_t begin, size_t end)
+        {
+            for (size_t chunk{ begin }; chunk < end; ++chunk)
+                func(chunk);
+        });
+    }
+
+    // LSD radix sort on 8-bit digits. Each chunk builds its own histogram and then scatters into its own slice of every
+    // bucket, so the passes can run in parallel and the sort stays stable
+    void radixSort()
+    {
+        const size_t n{ keys.size() };
+        keysScratch.resize(n);
+        indicesScratch.resize(n);
+
+        const size_t numChunks{ n < parallelSortThreshold ? 1 : std::min<size_t>(simulation::threadPool.getNumThreads() * 2, maxSortChunks) };
+        const size_t chunkSize{ (n + numChunks - 1) / numChunks };
+        std::array<uint32_t, 256>* const histograms{ simulation::frameArena.allocate<std::array<uint32_t, 256>>(numChunks) };
+
+        for (int shift{ 0 }; shift < 32; shift += 8)
+        {
+            runChunks(numChunks, [&](size_t chunk)
+            {
+                std::array<uint32_t, 256>& histogram{ histograms[chunk] };
+                histogram.fill(0);
+                for (size_t i{ chunk * chunkSize }; i < std::min(n, (chunk + 1) * chunkSize); ++i)
+                    ++histogram[(keys[i] >> shift) & 0xFF];
+            });
+
+            // Turn the counts into where each chunk starts writing each digit
+            uint32_t offset{ 0 };
+            for (size_t digit{ 0 }; digit < 256; ++digit)
+            {
+                for (size_t chunk{ 0 }; chunk < numChunks; ++chunk)
+                {
+                    const uint32_t count{ histograms[chunk][digit] };
+                    histograms[chunk][digit] = offset;
+                    offset += count;
+                }
+            }
+
+            runChunks(numChunks, [&](size_t chunk)
+            {
+                std::array<uint32_t, 256>& writePos{ histograms[chunk] };
+                for (size_t i{ chunk * chunkSize }; i < std::min(n, (chunk + 1) * chunkSize); ++i)
+                {
+                    const uint32_t dst{ writePos[(keys[i] >> shift) & 0xFF]++ };
+                    keysScratch[dst] = keys[i];
+                    indicesScratch[dst] = indices[i];
+                }
+            });
+
+            keys.swap(keysScratch);
+            indices.swap(indicesScratch);
+        }
+    }
+}
+
+namespace simulation::boid::morton
+{
+    int framesSinceReorder{ 0 };
+    float localityAfterLastReorder{ 0.0f };
+    float currentLocality{ 0.0f };
+
+    void reorderIfNeeded(const SimParams& params)
+    {
+        ++framesSinceReorder;
+        if (!params.mortonReorder)
+            return;
+
+        currentLocality = measureLocality();
+        if (framesSinceReorder < params.mortonReorderInterval && currentLocality >= localityAfterLastReorder * localityDropFactor)
+            return;
+
+        reorder(params);
+    }
+
+    void reorder(const SimParams& params)
+    {
+        BoidStore& boids{ BoidObject::s_boids };
+
+        keys.resize(boids.size());
+        indices.resize(boids.size());
+        for (size_t i{ 0 }; i < boids.size(); ++i)
+        {
+            const glm::vec2 pos{ boids.getPos(i) };
+            keys[i] = getMortonCode(params, pos.x, pos.y);
+            indices[i] = static_cast<uint32_t>(i);
+        }
+
+        radixSort();
+
+        boids.permute(indices);
+
+        framesSinceReorder = 0;
+        currentLocality = measureLocality();
+        localityAfterLastReorder = currentLocality;
+    }
+
+    float measureLocality()
+    {
+        const BoidStore& boids{ BoidObject::s_boids };
+        // The grid only gets its dimensions on its first rebuild, which comes after the first reorder
+        if (boids.size() < 2 || grid::numCellsX == 0)
+            return 1.0f;
+
+        size_t numLocal{ 0 };
+        int lastCell{ grid::getCellIndex(boids.getPos(0)) };
+        for (size_t i{ 1 }; i < boids.size(); ++i)
+        {
+            const int cell{ grid::getCellIndex(boids.getPos(i)) };
+
+            // Distance in cells, accounting for wraparound
+            int dx{ std::abs(cell % grid::numCellsX - lastCell % grid::numCellsX) };
+            int dy{ std::abs(cell / grid::numCellsX - lastCell / grid::numCellsX) };
+            dx = std::min(dx, grid::numCellsX - dx);
+            dy = std::min(dy, grid::numCellsY - dy);
+            if (dx <= 1 && dy <= 1)
+                ++numLocal;
+
+            lastCell = cell;
+        }
+
+        return static_cast<float>(numLocal) / static_cast<float>(boids.size() - 1);
+    }
+
+    uint32_t getMortonCode(const SimParams& params, float x, float y)
+    {
+        return spreadBits(quantize(x, params.worldSize.x)) | (spreadBits(quantize(y, params.worldSize.y)) << 1);
+    }
+}
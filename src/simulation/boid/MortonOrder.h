@@ -0,0 +1,23 @@
+#pragma once
+
+#include "../SimParams.h"
+
+#include <cstdint>
+
+// Periodically sorts BoidObject::s_boids along a Z-curve (Morton order) of their positions so that boids that are
+// close on screen are also close in memory. This makes the neighbor loop in updateBoids a lot more cache friendly
+namespace simulation::boid::morton
+{
+    extern int framesSinceReorder;
+    extern float localityAfterLastReorder;
+    extern float currentLocality;
+
+    // Has to be called before anything that indexes into s_boids for the frame (like updatedVelocities in updateBoids)
+    void reorderIfNeeded(const SimParams& params);
+    void reorder(const SimParams& params);
+
+    // Fraction of boids whose successor in s_boids is in the same or an adjacent grid cell
+    float measureLocality();
+
+    uint32_t getMortonCode(const SimParams& params, float x, float y);
+}
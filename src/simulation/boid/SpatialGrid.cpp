@@ -0,0 +1,198 @@
+#include "SpatialGrid.h"
+#include "BoidObject.h"
+#include "BoidParams.h"
+#include "../SimParams.h"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    using simulation::SimParams;
+
+    // Keeps the grid from blowing up in size when the vision radius gets really small (or zero)
+    constexpr int maxCellsPerAxis{ 512 };
+
+    // Scratch buffer for the counting sort so we don't reallocate every frame
+    std::vector<int> boidCells{};
+
+    // The vision radius and world size the current dimensions were worked out for
+    float dimensionsRadius{ -1.0f };
+    glm::vec2 dimensionsWorldSize{ 0.0f };
+
+    int wrapCell(int cell, int numCells)
+    {
+        cell %= numCells;
+        return cell < 0 ? cell + numCells : cell;
+    }
+
+    int getCellX(float x) { return wrapCell(static_cast<int>(std::floor(x / simulation::boid::grid::cellWidth)), simulation::boid::grid::numCellsX); }
+    int getCellY(float y) { return wrapCell(static_cast<int>(std::floor(y / simulation::boid::grid::cellHeight)), simulation::boid::grid::numCellsY); }
+
+    // Writes the unique rows/columns adjacent to (and including) cell. If there are less than 3, that's every row/column
+    int getAdjacent(int cell, int numCells, std::array<int, 3>& out)
+    {
+        if (numCells < 3)
+        {
+            for (int i{ 0 }; i < numCells; ++i)
+                out[i] = i;
+            return numCells;
+        }
+
+        out[0] = wrapCell(cell - 1, numCells);
+        out[1] = cell;
+        out[2] = wrapCell(cell + 1, numCells);
+        return 3;
+    }
+
+    // Slack for float rounding so the culling never throws out a cell the per-pair test would have kept something from
+    constexpr float cullMargin{ 1e-4f };
+
+    // Conservative test for whether any point of the box [min, max] (relative to the boid) could pass the radius and vision
+    // cone tests. The box can't contain the boid itself
+    bool isBoxInView(const SimParams& params, glm::vec2 min, glm::vec2 max, glm::vec2 heading)
+    {
+        const float visionRadius{ params.visionRadius };
+        const float visionAngleCos{ params.visionAngleCos };
+
+        const glm::vec2 closest{ std::clamp(0.0f, min.x, max.x), std::clamp(0.0f, min.y, max.y) };
+        if (glm::dot(closest, closest) > visionRadius * visionRadius * (1.0f + cullMargin))
+            return false;
+
+        const std::array<glm::vec2, 4> corners{ min, glm::vec2{ max.x, min.y }, max, glm::vec2{ min.x, max.y } };
+        const auto allCorners{ [&](auto&& test) { return std::all_of(corners.begin(), corners.end(), test); } };
+
+        // Wider than 180 degrees, so the blind spot behind the boid is a convex cone. The box is out of view if it's
+        // completely inside the blind spot, which is the case when all of its corners are
+        if (visionAngleCos <= 0.0f)
+            return !allCorners([&](glm::vec2 c) { return glm::dot(heading, c) < (visionAngleCos - cullMargin) * glm::length(c); });
+
+        // Narrower than 180 degrees, so the vision cone itself is convex and the box is out of view if it's completely behind
+        // one of the cone's two edges or behind the boid
+        const float visionAngleSin{ std::sqrt(1.0f - visionAngleCos * visionAngleCos) };
+        const glm::vec2 leftEdge{ heading.x * visionAngleCos - heading.y * visionAngleSin, heading.x * visionAngleSin + heading.y * visionAngleCos };
+        const glm::vec2 rightEdge{ heading.x * visionAngleCos + heading.y * visionAngleSin, -heading.x * visionAngleSin + heading.y * visionAngleCos };
+        const auto cross{ [](glm::vec2 a, glm::vec2 b) { return a.x * b.y - a.y * b.x; } };
+
+        if (allCorners([&](glm::vec2 c) { return cross(leftEdge, c) > cullMargin * glm::length(c); }))
+            return false;
+        if (allCorners([&](glm::vec2 c) { return cross(rightEdge, c) < -cullMargin * glm::length(c); }))
+            return false;
+        if (allCorners([&](glm::vec2 c) { return glm::dot(heading, c) < -cullMargin * glm::length(c); }))
+            return false;
+
+        return true;
+    }
+}
+
+namespace simulation::boid::grid
+{
+    int numCellsX{ 0 };
+    int numCellsY{ 0 };
+    float cellWidth{ 0.0f };
+    float cellHeight{ 0.0f };
+
+    std::vector<unsigned int> cellStart{};
+    std::vector<unsigned int> sortedIndices{};
+    std::vector<unsigned int> sortedSlots{};
+
+    void recomputeDimensions(const SimParams& params)
+    {
+        // Cells are never smaller than the vision radius, so the screen gets split into as many whole cells as fit
+        const float minCellSize{ std::max(params.visionRadius, params.worldSize.x / maxCellsPerAxis) };
+        numCellsX = std::clamp(static_cast<int>(params.worldSize.x / minCellSize), 1, maxCellsPerAxis);
+        numCellsY = std::clamp(static_cast<int>(params.worldSize.y / minCellSize), 1, maxCellsPerAxis);
+        cellWidth = params.worldSize.x / numCellsX;
+        cellHeight = params.worldSize.y / numCellsY;
+
+        cellStart.assign(numCellsX * numCellsY + 1, 0);
+        dimensionsRadius = params.visionRadius;
+        dimensionsWorldSize = params.worldSize;
+    }
+
+    void rebuild(const SimParams& params)
+    {
+        if (cellStart.empty() || params.visionRadius != dimensionsRadius || params.worldSize != dimensionsWorldSize)
+            recomputeDimensions(params);
+
+        const BoidStore& boids{ BoidObject::s_boids };
+        boidCells.resize(boids.size());
+        sortedIndices.resize(boids.size());
+        sortedSlots.resize(boids.size());
+        std::fill(cellStart.begin(), cellStart.end(), 0);
+
+        // Count the boids in each cell (offset by one so the prefix sum gives the start of each cell)
+        for (size_t i{ 0 }; i < boids.size(); ++i)
+        {
+            boidCells[i] = getCellIndex(boids.getPos(i));
+            ++cellStart[boidCells[i] + 1];
+        }
+
+        for (size_t c{ 1 }; c < cellStart.size(); ++c)
+            cellStart[c] += cellStart[c - 1];
+
+        // Scatter. cellStart gets shifted forward by one cell while doing this, so shift it back afterwards
+        for (size_t i{ 0 }; i < boids.size(); ++i)
+        {
+            sortedSlots[i] = cellStart[boidCells[i]]++;
+            sortedIndices[sortedSlots[i]] = static_cast<unsigned int>(i);
+        }
+
+        for (size_t c{ cellStart.size() - 1 }; c > 0; --c)
+            cellStart[c] = cellStart[c - 1];
+        cellStart[0] = 0;
+    }
+
+    int getCellIndex(glm::vec2 pos)
+    {
+        return getCellY(pos.y) * numCellsX + getCellX(pos.x);
+    }
+
+    NeighborCells getNeighborCells(glm::vec2 pos)
+    {
+        std::array<int, 3> columns, rows;
+        const int numColumns{ getAdjacent(getCellX(pos.x), numCellsX, columns) };
+        const int numRows{ getAdjacent(getCellY(pos.y), numCellsY, rows) };
+
+        NeighborCells neighborCells{};
+        for (int r{ 0 }; r < numRows; ++r)
+            for (int c{ 0 }; c < numColumns; ++c)
+                neighborCells.cells[neighborCells.count++] = rows[r] * numCellsX + columns[c];
+
+        return neighborCells;
+    }
+
+    NeighborCells getVisibleNeighborCells(const SimParams& params, glm::vec2 pos, glm::vec2 velocity)
+    {
+        // With fewer than 4 cells across, the copy of a neighboring cell next to the boid isn't always the closest one
+        // (which is what the wraparound in the per-pair test uses), so just don't cull
+        if (numCellsX < 4 || numCellsY < 4 || params.visionAngleCos <= -1.0f)
+            return getNeighborCells(pos);
+
+        const int cellX{ getCellX(pos.x) };
+        const int cellY{ getCellY(pos.y) };
+        const glm::vec2 wrappedPos{ pos.x - std::floor(pos.x / params.worldSize.x) * params.worldSize.x,
+                                    pos.y - std::floor(pos.y / params.worldSize.y) * params.worldSize.y };
+        const glm::vec2 heading{ glm::normalize(velocity) };
+        const glm::vec2 margin{ cellWidth * cullMargin, cellHeight * cullMargin };
+
+        NeighborCells neighborCells{};
+        for (int row{ -1 }; row <= 1; ++row)
+        {
+            for (int column{ -1 }; column <= 1; ++column)
+            {
+                const glm::vec2 min{ glm::vec2{ (cellX + column) * cellWidth, (cellY + row) * cellHeight } - wrappedPos - margin };
+                const glm::vec2 max{ min + glm::vec2{ cellWidth, cellHeight } + margin * 2.0f };
+                if (row != 0 || column != 0)
+                    if (!isBoxInView(params, min, max, heading))
+                        continue;
+
+                neighborCells.cells[neighborCells.count++] = wrapCell(cellY + row, numCellsY) * numCellsX + wrapCell(cellX + column, numCellsX);
+            }
+        }
+
+        return neighborCells;
+    }
+}
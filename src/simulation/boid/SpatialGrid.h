@@ -0,0 +1,43 @@
+#pragma once
+
+#include "../SimParams.h"
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <vector>
+
+// Uniform grid over the (wrapping) screen used to find boids near each other without checking every pair.
+// Cells are at least visionRadius wide, so anything a boid can see is in the 3x3 block of cells around it
+namespace simulation::boid::grid
+{
+    extern int numCellsX;
+    extern int numCellsY;
+    extern float cellWidth;
+    extern float cellHeight;
+
+    // Boids sorted by cell (counting sort). The boids in cell c are sortedIndices[cellStart[c]] up to sortedIndices[cellStart[c + 1]]
+    extern std::vector<unsigned int> cellStart;
+    extern std::vector<unsigned int> sortedIndices;
+    // The inverse of sortedIndices: where boid i ended up in the sorted order
+    extern std::vector<unsigned int> sortedSlots;
+
+    // The (up to) 9 unique cells around a position. There can be fewer than 9 if the grid is less than 3 cells wide or tall
+    struct NeighborCells
+    {
+        std::array<int, 9> cells{};
+        int count{ 0 };
+
+        const int* begin() const { return cells.data(); }
+        const int* end() const { return cells.data() + count; }
+    };
+
+    void recomputeDimensions(const SimParams& params);
+    void rebuild(const SimParams& params);
+    int getCellIndex(glm::vec2 pos);
+    NeighborCells getNeighborCells(glm::vec2 pos);
+
+    // Same as getNeighborCells, but leaves out cells that are completely outside the boid's vision radius and cone. The test
+    // is conservative, so it never drops a cell that has a boid the per-pair test would count
+    NeighborCells getVisibleNeighborCells(const SimParams& params, glm::vec2 pos, glm::vec2 velocity);
+}
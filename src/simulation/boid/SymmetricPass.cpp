@@ -0,0 +1,83 @@
+#include "SymmetricPass.h"
+#include "BoidObject.h"
+#include "SpatialGrid.h"
+#include "../SimParams.h"
+#include "../ThreadPool.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+    namespace kernel = simulation::boid::kernel;
+    namespace grid = simulation::boid::grid;
+    using simulation::SimParams;
+
+    // Sums in grid cell order (the same order as kernel::neighborData)
+    kernel::SumArrays sums{};
+
+    void addCellPair(const SimParams& params, int cellA, int cellB)
+    {
+        const kernel::Range others{ grid::cellStart[cellB], grid::cellStart[cellB + 1] };
+        for (unsigned int a{ grid::cellStart[cellA] }; a < grid::cellStart[cellA + 1]; ++a)
+            kernel::addPairs(params, a, others, sums);
+    }
+
+    void addCell(const SimParams& params, int cell)
+    {
+        for (unsigned int a{ grid::cellStart[cell] }; a < grid::cellStart[cell + 1]; ++a)
+            kernel::addPairs(params, a, { a + 1, grid::cellStart[cell + 1] }, sums);
+    }
+
+    // Only writes to the sums of boids in row y and the row below it
+    void processRow(const SimParams& params, int y)
+    {
+        const int nextRow{ (y + 1) % grid::numCellsY };
+        for (int x{ 0 }; x < grid::numCellsX; ++x)
+        {
+            const int cell{ y * grid::numCellsX + x };
+            const int left{ (x + grid::numCellsX - 1) % grid::numCellsX };
+            const int right{ (x + 1) % grid::numCellsX };
+
+            addCell(params, cell);
+            addCellPair(params, cell, y * grid::numCellsX + right);
+            addCellPair(params, cell, nextRow * grid::numCellsX + left);
+            addCellPair(params, cell, nextRow * grid::numCellsX + x);
+            addCellPair(params, cell, nextRow * grid::numCellsX + right);
+        }
+    }
+
+    // Rows firstRow, firstRow + 2 and so on, up to (not including) endRow
+    void processEveryOtherRow(const SimParams& params, int firstRow, int endRow)
+    {
+        simulation::threadPool.parallelFor(static_cast<size_t>(std::max(endRow - firstRow + 1, 0) / 2), 1, [&](size_t begin, size_t end)
+        {
+            for (size_t i{ begin }; i < end; ++i)
+                processRow(params, firstRow + static_cast<int>(i) * 2);
+        });
+    }
+}
+
+bool simulation::boid::symmetric::isAvailable()
+{
+    return grid::numCellsX >= 3 && grid::numCellsY >= 3;
+}
+
+void simulation::boid::symmetric::accumulate(const SimParams& params)
+{
+    sums.reset(BoidObject::s_boids.size());
+
+    // Rows in the same phase never write to the same row. With an odd number of rows the last one wraps around onto
+    // row 0, so it gets its own phase
+    const int numRows{ grid::numCellsY };
+    const int lastPairedRow{ numRows % 2 == 0 ? numRows : numRows - 1 };
+    processEveryOtherRow(params, 0, lastPairedRow);
+    processEveryOtherRow(params, 1, lastPairedRow);
+    if (lastPairedRow != numRows)
+        processEveryOtherRow(params, numRows - 1, numRows);
+}
+
+simulation::boid::kernel::NeighborSums simulation::boid::symmetric::getSums(size_t boidIndex)
+{
+    return sums.get(grid::sortedSlots[boidIndex]);
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "FlockKernel.h"
+
+// Alternative to calling kernel::sumNeighbors once per boid. The per-boid kernel looks at every pair twice (once from
+// each side), so this pass walks each pair of adjacent cells once instead, works out the wrapped vector, distance and
+// direction between the two boids once, and then does each boid's own vision cone test and adds into both boids' sums.
+// The pair loop is kernel::addPairs, which takes one boid against a SIMD register's worth of the other cell's at a time.
+// With AVX-512 that's about 28 ms a step for 20000 boids on one thread against 36 ms for the grid (42 vs 50 ms with
+// AVX2). There's no SSE4.2 version, so without AVX2 the pairs go through the scalar loop and it's about twice as slow
+// as the grid (157 vs 81 ms).
+//
+// Cell pairs are visited with a half stencil (the cell itself plus the right, down-left, down and down-right cells).
+// A row of cells only writes to itself and the row below it, so rows get processed in two alternating phases (three
+// if the number of rows is odd) and rows in the same phase can run on different threads without any locking
+namespace simulation::boid::symmetric
+{
+    // The half stencil only covers every pair exactly once when the grid is at least 3x3
+    bool isAvailable();
+
+    // Has to be called after kernel::gatherNeighborData()
+    void accumulate(const SimParams& params);
+
+    kernel::NeighborSums getSums(size_t boidIndex);
+}
@@ -1,11 +1,8 @@
 #pragma once
 
-#include <GL/glew.h>
-#include <GLFW/glfw3.h>
 #include <glm/glm.hpp>
 
 #include <vector>
-#include <array>
 
 namespace simulation::obstacle
 {
@@ -15,7 +12,6 @@ namespace simulation::obstacle
             static std::vector<Obstacle> s_obstacles;
 
             static void createObstacle(glm::vec2 pos);
-            static void renderAllObstacles();
 
             Obstacle(glm::vec2 pos) : m_pos{ pos } {}
             glm::vec2 getPos() const { return m_pos; }
@@ -26,10 +22,8 @@ namespace simulation::obstacle
 
     extern float defaultRadius;
     extern float radius;
-    extern GLuint VAO, VBO;
-    extern std::array<GLfloat, 104> vertices; // So really 51 vertices (including middle)
 
-    void init();
-    void recomputeVBO();
-    void makeBigCircleObstacle();
+    // Sets the radius from the world size
+    void init(glm::vec2 worldSize);
+    void makeBigCircleObstacle(glm::vec2 worldSize);
 }
@@ -0,0 +1,59 @@
+# Runs boids_headless in deterministic mode with settings that change how the work gets split up or the order the
+# neighbors get visited in, which shouldn't change the result (see Determinism.h), and fails if any of them prints a
+# different state hash than the first. Each flocking setting in BEHAVIORS gets its own reference hash, since those do
+# change the result. --no-ghost-cells checks that deterministic mode really does skip the ghost cells, which would sum
+# in a different order.
+#
+# The default 200 steps are a smoke test: a divergence that only shows up as a bit flip in a rare case can take far
+# longer to grow into a different hash. DeterminismCheckLong runs the same thing for 100000 steps, but only when asked
+# for with ctest -C Long. Run through ctest, which passes HEADLESS (and STEPS) in:
+#
+#   cmake -DHEADLESS=<path to boids_headless> [-DSTEPS=<count>] -P tests/DeterminismCheck.cmake
+
+if (NOT HEADLESS)
+    message(FATAL_ERROR "HEADLESS has to be set to the boids_headless executable")
+endif()
+
+if (NOT STEPS)
+    set(STEPS 200)
+endif()
+
+set(COMMON_ARGS --deterministic --seed 7 --boids 3000 --steps ${STEPS})
+
+set(BEHAVIORS
+    "--vision-angle 270"
+    "--vision-angle 120"
+    "--topological 7"
+)
+
+set(CONFIGS
+    "--threads 1"
+    "--threads 3"
+    "--threads 8"
+    "--threads 64 --morton"
+    "--threads 8 --no-ghost-cells"
+)
+
+foreach(BEHAVIOR ${BEHAVIORS})
+    set(EXPECTED_HASH "")
+    foreach(CONFIG ${CONFIGS})
+        separate_arguments(RUN_ARGS UNIX_COMMAND "${BEHAVIOR} ${CONFIG}")
+        execute_process(COMMAND ${HEADLESS} ${COMMON_ARGS} ${RUN_ARGS} OUTPUT_VARIABLE OUTPUT RESULT_VARIABLE RESULT)
+        if (NOT RESULT EQUAL 0)
+            message(FATAL_ERROR "boids_headless ${BEHAVIOR} ${CONFIG} failed (${RESULT}):\n${OUTPUT}")
+        endif()
+
+        string(REGEX MATCH "State hash after step [0-9]+: [0-9a-f]+" HASH_LINE "${OUTPUT}")
+        if (NOT HASH_LINE)
+            message(FATAL_ERROR "boids_headless ${BEHAVIOR} ${CONFIG} didn't print a state hash:\n${OUTPUT}")
+        endif()
+
+        message(STATUS "${BEHAVIOR} ${CONFIG}: ${HASH_LINE}")
+        if (EXPECTED_HASH STREQUAL "")
+            set(EXPECTED_HASH "${HASH_LINE}")
+            set(EXPECTED_CONFIG "${CONFIG}")
+        elseif (NOT HASH_LINE STREQUAL EXPECTED_HASH)
+            message(FATAL_ERROR "${BEHAVIOR} ${CONFIG} gave \"${HASH_LINE}\" but ${EXPECTED_CONFIG} gave \"${EXPECTED_HASH}\"")
+        endif()
+    endforeach()
+endforeach()
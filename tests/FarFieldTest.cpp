@@ -0,0 +1,51 @@
+#include "TestFlock.h"
+#include "../src/simulation/boid/FarField.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+namespace
+{
+    namespace farfield = simulation::boid::farfield;
+
+    // Runs one step with the far field on and returns what the error measurement in that step found
+    farfield::ErrorStats measure(simulation::SimParams params, float openingAngle)
+    {
+        params.farFieldAggregates = true;
+        params.farFieldOpeningAngle = openingAngle;
+        farfield::errorMeasurementRequested = true;
+        simulation::boid::BoidObject::updateBoids(params, 1.0f / static_cast<float>(params.simulationTickRate));
+        return farfield::lastError;
+    }
+}
+
+// The far-field approximation against the exact per-pair sums, at the 8x vision radius it's meant for. An opening angle
+// of 0 never approximates anything, so all that's left there is the order the floats get added in
+int main()
+{
+    simulation::SimParams params{ test::makeParams() };
+    test::spawnFlock(params, 5000, 300);
+    params.visionRadius *= 8.0f;
+
+    const farfield::ErrorStats exact{ measure(params, 0.0f) };
+    if (exact.numSampled == 0)
+    {
+        std::printf("no boids with neighbors sampled  FAILED\n");
+        return EXIT_FAILURE;
+    }
+
+    bool passed{ true };
+    passed &= test::check("angle 0: max separation error", exact.maxSeparation, 1e-5);
+    passed &= test::check("angle 0: max alignment error", exact.maxAlignment, 1e-5);
+    passed &= test::check("angle 0: max cohesion error", exact.maxCohesion, 5e-5);
+
+    const farfield::ErrorStats approximate{ measure(params, 0.5f) };
+    passed &= test::check("angle 0.5: mean separation error", approximate.meanSeparation, 3e-3);
+    passed &= test::check("angle 0.5: max separation error", approximate.maxSeparation, 1e-2);
+    passed &= test::check("angle 0.5: mean alignment error", approximate.meanAlignment, 5e-3);
+    passed &= test::check("angle 0.5: max alignment error", approximate.maxAlignment, 2e-2);
+    passed &= test::check("angle 0.5: mean cohesion error", approximate.meanCohesion, 1e-5);
+    passed &= test::check("angle 0.5: max cohesion error", approximate.maxCohesion, 5e-5);
+
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
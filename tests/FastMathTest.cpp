@@ -0,0 +1,18 @@
+#include "TestFlock.h"
+#include "../src/simulation/FastMath.h"
+
+#include <cstdlib>
+
+// The worst case errors measureErrors() finds against the bounds the approximations document in FastMath.h
+int main()
+{
+    const simulation::fastmath::ErrorStats errors{ simulation::fastmath::measureErrors() };
+
+    bool passed{ true };
+    passed &= test::check("rsqrt relative error", errors.rsqrtRelative, 5e-6);
+    passed &= test::check("sincos absolute error", errors.sinCosAbsolute, 2e-7);
+    passed &= test::check("atan2 absolute error", errors.atan2Absolute, 3e-6);
+    passed &= test::check("wrap absolute error", errors.wrapAbsolute, 0.0);
+
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
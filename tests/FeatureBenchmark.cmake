@@ -0,0 +1,49 @@
+# Times boids_headless with each of the features the per-boid update gets specialized on (see getActiveFeatures in
+# BoidObject.cpp) turned on by itself, against a baseline with all of them off, and prints the steps per second of each.
+# It doesn't check anything, so ctest only runs it when asked for with ctest -C Benchmark (add -V to see the numbers):
+#
+#   cmake -DHEADLESS=<path to boids_headless> [-DBOIDS=<count>] [-DSTEPS=<count>] -P tests/FeatureBenchmark.cmake
+
+if (NOT HEADLESS)
+    message(FATAL_ERROR "HEADLESS has to be set to the boids_headless executable")
+endif()
+
+if (NOT BOIDS)
+    set(BOIDS 20000)
+endif()
+if (NOT STEPS)
+    set(STEPS 300)
+endif()
+
+set(COMMON_ARGS --seed 1 --boids ${BOIDS} --steps ${STEPS} --threads 1)
+
+# Name, then the options. Blending hues is what turns on the hue noise, and the noise only gets added below a saturation
+# of 0.7, so the blending case raises the saturation to leave it off
+set(CASES
+    "baseline|--no-blend-hues"
+    "hue blending|--saturation 0.8"
+    "hue noise|--saturation 0.35"
+    "mouse avoidance|--no-blend-hues --avoid-mouse"
+    "obstacles|--no-blend-hues --obstacles"
+    "full cone|--no-blend-hues --vision-angle 360"
+    "everything|--saturation 0.35 --avoid-mouse --obstacles --vision-angle 360"
+)
+
+foreach(CASE ${CASES})
+    string(REPLACE "|" ";" CASE_PARTS "${CASE}")
+    list(GET CASE_PARTS 0 CASE_NAME)
+    list(GET CASE_PARTS 1 CASE_OPTIONS)
+
+    separate_arguments(CASE_ARGS UNIX_COMMAND "${CASE_OPTIONS}")
+    execute_process(COMMAND ${HEADLESS} ${COMMON_ARGS} ${CASE_ARGS} OUTPUT_VARIABLE OUTPUT RESULT_VARIABLE RESULT)
+    if (NOT RESULT EQUAL 0)
+        message(FATAL_ERROR "boids_headless ${CASE_OPTIONS} failed (${RESULT}):\n${OUTPUT}")
+    endif()
+
+    string(REGEX MATCH "[0-9.]+ steps/s \\([0-9.]+ ms per step" SPEED "${OUTPUT}")
+    if (NOT SPEED)
+        message(FATAL_ERROR "boids_headless ${CASE_OPTIONS} didn't print its speed:\n${OUTPUT}")
+    endif()
+
+    message(STATUS "${CASE_NAME} (${CASE_OPTIONS}): ${SPEED})")
+endforeach()
@@ -0,0 +1,101 @@
+#include "TestFlock.h"
+#include "../src/simulation/boid/FlockKernel.h"
+#include "../src/simulation/boid/SpatialGrid.h"
+#include "../src/simulation/CpuFeatures.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+// Every SIMD kernel the CPU supports against the scalar one, over every boid of a clumped up flock. Bounds are the ones
+// documented in FlockKernel.h
+namespace
+{
+    namespace kernel = simulation::boid::kernel;
+    namespace grid = simulation::boid::grid;
+    using simulation::cpu::SimdLevel;
+
+    struct Differences
+    {
+        // Largest absolute difference in any component of separation, alignment and the hue sums, and in the average
+        // neighbor position (cohesion / numVisible), over the boids that both kernels found the same neighbors for
+        double unitSums{ 0.0 };
+        double averagePosition{ 0.0 };
+        // Boids a neighbor within rounding of the radius or cone edge landed on different sides of the test for. Their sums
+        // differ by that neighbor's whole contribution, so they're counted instead of compared
+        int numVisible{ 0 };
+        size_t numBoidsWithDifferentNeighbors{ 0 };
+    };
+
+    double maxDifference(glm::vec2 a, glm::vec2 b)
+    {
+        return std::max(std::abs(static_cast<double>(a.x) - b.x), std::abs(static_cast<double>(a.y) - b.y));
+    }
+
+    Differences compare(const simulation::SimParams& params)
+    {
+        Differences differences{};
+        const simulation::boid::BoidStore& boids{ simulation::boid::BoidObject::s_boids };
+        for (size_t i{ 0 }; i < boids.size(); ++i)
+        {
+            const glm::vec2 pos{ boids.getPos(i) };
+            const glm::vec2 velocity{ boids.getVelocity(i) };
+            const grid::NeighborCells cells{ grid::getNeighborCells(pos) };
+            const kernel::NeighborSums scalar{ kernel::sumNeighborsScalar(params, pos, velocity, cells) };
+            const kernel::NeighborSums simd{ kernel::sumNeighbors(params, pos, velocity, cells) };
+
+            if (scalar.numVisible != simd.numVisible)
+            {
+                differences.numVisible = std::max(differences.numVisible, std::abs(scalar.numVisible - simd.numVisible));
+                ++differences.numBoidsWithDifferentNeighbors;
+                continue;
+            }
+
+            differences.unitSums = std::max({ differences.unitSums, maxDifference(scalar.separation, simd.separation), maxDifference(scalar.alignment, simd.alignment),
+                                              maxDifference({ scalar.hueSin, scalar.hueCos }, { simd.hueSin, simd.hueCos }) });
+            if (scalar.numVisible > 0)
+            {
+                const float numVisible{ static_cast<float>(scalar.numVisible) };
+                differences.averagePosition = std::max(differences.averagePosition, maxDifference(scalar.cohesion / numVisible, simd.cohesion / numVisible));
+            }
+        }
+
+        return differences;
+    }
+}
+
+int main()
+{
+    simulation::SimParams params{ test::makeParams() };
+    test::spawnFlock(params, 20000, 300);
+    grid::rebuild(params);
+    kernel::gatherNeighborData(params);
+
+    bool passed{ true };
+    for (const SimdLevel level : { SimdLevel::sse42, SimdLevel::avx2, SimdLevel::avx512 })
+    {
+        if (kernel::setSimdLevel(level) != level)
+        {
+            std::printf("%s: not supported, skipped\n", simulation::cpu::getSimdLevelName(level));
+            continue;
+        }
+
+        // With the default cone and with the full circle, which skips the cone test
+        for (const float visionAngleCos : { params.visionAngleCos, -1.0f })
+        {
+            simulation::SimParams levelParams{ params };
+            levelParams.visionAngleCos = visionAngleCos;
+            const Differences differences{ compare(levelParams) };
+
+            std::printf("%s, vision angle cos %g\n", simulation::cpu::getSimdLevelName(level), visionAngleCos);
+            passed &= test::check("  separation, alignment and hue sums", differences.unitSums, 1e-3);
+            passed &= test::check("  average neighbor position", differences.averagePosition, 1e-2);
+            passed &= test::check("  visible neighbors", differences.numVisible, 1);
+            // Out of 20000. Any more than a handful would mean the tests themselves disagree, not just their rounding
+            passed &= test::check("  boids with different neighbors", static_cast<double>(differences.numBoidsWithDifferentNeighbors), 20);
+        }
+    }
+
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,92 @@
+#include "TestFlock.h"
+#include "../src/simulation/boid/FlockStats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace
+{
+    namespace flockstats = simulation::boid::flockstats;
+
+    constexpr size_t numBoids{ 2000 };
+    constexpr int warmupSteps{ 500 };
+    constexpr int numSamples{ 200 };
+    constexpr int stepsPerSample{ 50 };
+    constexpr uint64_t numSeeds{ 12 };
+
+    float getMedian(std::vector<float> values)
+    {
+        std::sort(values.begin(), values.end());
+        const size_t middle{ values.size() / 2 };
+        return values.size() % 2 == 0 ? (values[middle - 1] + values[middle]) / 2.0f : values[middle];
+    }
+
+    // Each seed's stats averaged over 10000 steps after the flock has settled in, and then the median over the seeds,
+    // which is what it takes to get them within noise of another run that ends up with the boids in different places
+    flockstats::Stats measureMedian(const simulation::SimParams& params)
+    {
+        std::vector<float> polarizations{};
+        std::vector<float> neighborCounts{};
+        for (uint64_t seed{ 1 }; seed <= numSeeds; ++seed)
+        {
+            test::spawnFlock(params, numBoids, warmupSteps, seed);
+
+            flockstats::Stats average{};
+            for (int sample{ 0 }; sample < numSamples; ++sample)
+            {
+                for (int step{ 0 }; step < stepsPerSample; ++step)
+                    simulation::boid::BoidObject::updateBoids(params, 1.0f / static_cast<float>(params.simulationTickRate));
+
+                const flockstats::Stats stats{ flockstats::measure(params) };
+                average.polarization += stats.polarization;
+                average.averageNeighbors += stats.averageNeighbors;
+            }
+
+            polarizations.push_back(average.polarization / static_cast<float>(numSamples));
+            neighborCounts.push_back(average.averageNeighbors / static_cast<float>(numSamples));
+        }
+
+        return { getMedian(polarizations), getMedian(neighborCounts) };
+    }
+
+    // Polarization is the noisy one. Over 10000 steps most seeds average between 0.9 and 0.98, but now and then one stays
+    // split into flocks heading different ways for the whole run and averages as low as 0.3, which would drag a mean over
+    // the seeds down by several hundredths. The median shrugs that off and moves by under 0.02 between two equivalent
+    // runs. The neighbor count stays within a few percent. Both are far tighter than what broken headings or positions
+    // give (polarization near 0, or a neighbor count that's way off)
+    constexpr double maxPolarizationDifference{ 0.03 };
+    constexpr double maxRelativeNeighborDifference{ 0.05 };
+
+    bool checkAgainst(const char* name, const flockstats::Stats& reference, const flockstats::Stats& stats)
+    {
+        std::printf("%s: polarization %.3f, %.2f neighbors\n", name, stats.polarization, stats.averageNeighbors);
+        bool passed{ true };
+        passed &= test::check("  polarization difference", std::abs(stats.polarization - reference.polarization), maxPolarizationDifference);
+        passed &= test::check("  relative neighbor count difference",
+                              std::abs(stats.averageNeighbors - reference.averageNeighbors) / reference.averageNeighbors, maxRelativeNeighborDifference);
+        return passed;
+    }
+}
+
+// Compact boid state and fast math change every boid's path, but the flock as a whole should behave the same: the
+// polarization and neighbor counts over a dozen runs have to stay within noise of full float storage
+int main()
+{
+    const simulation::SimParams params{ test::makeParams() };
+    const flockstats::Stats reference{ measureMedian(params) };
+    std::printf("full storage: polarization %.3f, %.2f neighbors\n", reference.polarization, reference.averageNeighbors);
+
+    simulation::SimParams compactParams{ params };
+    compactParams.compactBoidState = true;
+    simulation::SimParams fastMathParams{ params };
+    fastMathParams.precision = simulation::fastmath::Precision::fast;
+
+    bool passed{ true };
+    passed &= checkAgainst("compact", reference, measureMedian(compactParams));
+    passed &= checkAgainst("fast math", reference, measureMedian(fastMathParams));
+
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "../src/simulation/boid/BoidObject.h"
+#include "../src/simulation/boid/BoidParams.h"
+#include "../src/simulation/obstacle/Obstacle.h"
+#include "../src/simulation/SimParams.h"
+#include "../src/simulation/Random.h"
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+
+// What the tests share: a flock set up the same way boids_headless sets one up with its default options, and a way to
+// report a measured number against the bound it has to stay under
+namespace test
+{
+    namespace boid = simulation::boid;
+
+    inline const glm::vec2 worldSize{ 1920.0f, 1080.0f };
+
+    // The UI's defaults for a worldSize world, on one thread
+    inline simulation::SimParams makeParams()
+    {
+        boid::globalVars::init(worldSize);
+        simulation::obstacle::init(worldSize);
+
+        simulation::SimParams params{};
+        params.worldSize = worldSize;
+        params.wrapMargin = boid::globalVars::triangleHeight;
+        params.separation = boid::globalVars::defaultSeparation;
+        params.alignment = boid::globalVars::defaultAlignment;
+        params.cohesion = boid::globalVars::defaultCohesion;
+        params.maxSpeed = boid::globalVars::defaultMaxSpeed;
+        params.visionRadius = boid::globalVars::defaultVisionRadius;
+        params.visionAngleCos = std::cos(glm::radians(boid::globalVars::defaultVisionAngleDegrees) / 2.0f);
+        params.obstacleRadius = simulation::obstacle::radius;
+        return params;
+    }
+
+    // Scatters numBoids boids evenly over the world and runs numSteps steps, so the flock has had time to clump up (which
+    // is where the sums have the most terms and cancel the most)
+    inline void spawnFlock(const simulation::SimParams& params, size_t numBoids, int numSteps, uint64_t seed = 1)
+    {
+        boid::BoidObject::s_boids.clear();
+        simulation::random::seed = seed;
+        for (size_t i{ 0 }; i < numBoids; ++i)
+        {
+            const std::array<float, 4> placement{ simulation::random::drawCentered(simulation::getSeed(params), simulation::random::Stream::spawn, boid::BoidObject::s_boids.getNextId(), 1) };
+            boid::BoidObject::createBoid(params, glm::vec2{ placement[0] + 1.0f, placement[1] + 1.0f } / 2.0f * params.worldSize);
+        }
+
+        for (int step{ 0 }; step < numSteps; ++step)
+            boid::BoidObject::updateBoids(params, 1.0f / static_cast<float>(params.simulationTickRate));
+    }
+
+    // Prints the measurement and whether it passed, and returns false if it didn't
+    inline bool check(const char* name, double measured, double bound)
+    {
+        const bool passed{ measured <= bound };
+        std::printf("%-40s %.3g (bound %.3g)%s\n", name, measured, bound, passed ? "" : "  FAILED");
+        return passed;
+    }
+}